@@ -3,18 +3,18 @@
   ----------------
   Implements the UI:
   - A rotary gain knob bound to the parameter system.
-  - A simple vertical meter that reads a peak value from the processor.
+  - A per-channel meter (RMS fill, peak line, clip LED) fed by the
+    processor's meter frame ring.
+  - A preset browser over the process-wide preset library's window,
+    which grows a page at a time as the list scrolls.
 */
 #include "PluginEditor.h"
-#include "infra/state/PresetStore.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <string>
 
-namespace
-{
-constexpr const char* kParamGainId = "gain";
-constexpr const char* kParamTrimId = "trim";
-}
-
 class ProGainAudioProcessorEditor::MeterComponent : public juce::Component, private juce::Timer
 {
 public:
@@ -22,8 +22,14 @@ public:
     : processor(proc)
   {
     // Smoothing for the visual meter (not audio).
-    meterSmoothed.reset(30.0, 0.15);
-    meterSmoothed.setCurrentAndTargetValue(0.0f);
+    for (auto& channel : channels)
+    {
+      channel.rmsSmoothed.reset(30.0, 0.15);
+      channel.rmsSmoothed.setCurrentAndTargetValue(0.0f);
+    }
+
+    // Frames queued while no editor was open are stale.
+    processor.clearMeterFrames();
     startTimerHz(30);
   }
 
@@ -35,44 +41,409 @@ public:
     g.setColour(juce::Colours::black.withAlpha(0.7f));
     g.fillRoundedRectangle(bounds, 6.0f);
 
-    // Draw filled meter.
-    const float level = juce::jlimit(0.0f, 1.0f, currentLevel);
-    auto fill = bounds;
-    fill.removeFromTop(bounds.getHeight() * (1.0f - level));
+    // One bar per channel: RMS as the fill, peak as a line, clip LED on top.
+    auto barsArea = bounds.reduced(4.0f);
+    auto ledRow = barsArea.removeFromTop(6.0f);
+    barsArea.removeFromTop(3.0f);
 
-    juce::Colour meterColour = juce::Colour::fromRGB(64, 196, 92);
-    if (level > 0.85f)
-      meterColour = juce::Colour::fromRGB(232, 98, 78);
-    else if (level > 0.65f)
-      meterColour = juce::Colour::fromRGB(232, 178, 62);
+    // Surround and ambisonic buses get thinner bars with tighter gaps.
+    const int shown = juce::jmax(1, numChannels);
+    const float gap = shown > 4 ? 1.0f : 3.0f;
+    const float barWidth = (barsArea.getWidth() - gap * (float) (shown - 1)) / (float) shown;
 
-    g.setColour(meterColour);
-    g.fillRoundedRectangle(fill, 6.0f);
+    for (int ch = 0; ch < shown; ++ch)
+    {
+      const auto& channel = channels[(size_t) ch];
+      const float x = barsArea.getX() + (float) ch * (barWidth + gap);
+      const juce::Rectangle<float> bar(x, barsArea.getY(), barWidth, barsArea.getHeight());
+
+      const float rms = juce::jlimit(0.0f, 1.0f, channel.rmsLevel);
+      auto fill = bar;
+      fill.removeFromTop(bar.getHeight() * (1.0f - rms));
+
+      g.setColour(levelColour(rms));
+      g.fillRoundedRectangle(fill, 3.0f);
+
+      // peakLevel already includes the true peak when that is switched on.
+      const float peak = juce::jlimit(0.0f, 1.0f, channel.peakLevel);
+      const float peakY = bar.getBottom() - bar.getHeight() * peak;
+      g.setColour(levelColour(peak).brighter(0.3f));
+      g.fillRect(bar.getX(), peakY - 1.0f, bar.getWidth(), 2.0f);
+
+      g.setColour(channel.clipped ? juce::Colour::fromRGB(232, 98, 78)
+                                  : juce::Colours::white.withAlpha(0.1f));
+      g.fillRoundedRectangle(x, ledRow.getY(), barWidth, ledRow.getHeight(), 2.0f);
+    }
 
     g.setColour(juce::Colours::white.withAlpha(0.15f));
     g.drawRoundedRectangle(bounds, 6.0f, 1.0f);
   }
 
+  // Click the meter to clear the clip indicators.
+  void mouseDown(const juce::MouseEvent&) override
+  {
+    for (auto& channel : channels)
+      channel.clipped = false;
+    repaint();
+  }
+
 private:
+  static juce::Colour levelColour(float level)
+  {
+    if (level > 0.85f)
+      return juce::Colour::fromRGB(232, 98, 78);
+    if (level > 0.65f)
+      return juce::Colour::fromRGB(232, 178, 62);
+    return juce::Colour::fromRGB(64, 196, 92);
+  }
+
   void timerCallback() override
   {
-    // Poll the processor's atomic meter and animate smoothly.
-    const float target = processor.getMeterLevel();
-    meterSmoothed.setTargetValue(target);
-    currentLevel = meterSmoothed.getNextValue();
+    // Drain every frame produced since the last tick so no block's peak is
+    // missed, and combine their RMS by energy.
+    std::array<float, dsp::MeterFrame::kMaxChannels> framePeak {};
+    std::array<double, dsp::MeterFrame::kMaxChannels> energy {};
+    int64_t samples = 0;
+
+    dsp::MeterFrame frame;
+    while (processor.popMeterFrame(frame))
+    {
+      numChannels = frame.numChannels;
+      samples += frame.numSamples;
+      for (int ch = 0; ch < frame.numChannels; ++ch)
+      {
+        const auto& meter = frame.channels[(size_t) ch];
+        framePeak[(size_t) ch] = juce::jmax(framePeak[(size_t) ch], meter.peak, meter.truePeak);
+        energy[(size_t) ch] += (double) meter.rms * meter.rms * frame.numSamples;
+        channels[(size_t) ch].clipped |= meter.clips > 0 || meter.truePeak > 1.0f;
+      }
+    }
+
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+      auto& channel = channels[ch];
+      const float rms = samples > 0 ? (float) std::sqrt(energy[ch] / (double) samples) : 0.0f;
+      channel.rmsSmoothed.setTargetValue(rms);
+      channel.rmsLevel = channel.rmsSmoothed.getNextValue();
+
+      // Peaks jump up instantly and fall back at ~20 dB/s.
+      channel.peakLevel = juce::jmax(framePeak[ch], channel.peakLevel * 0.9261f);
+    }
     repaint();
   }
 
+  struct ChannelDisplay
+  {
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> rmsSmoothed;
+    float rmsLevel { 0.0f };
+    float peakLevel { 0.0f };
+    bool clipped { false };
+  };
+
   ProGainAudioProcessor& processor;
-  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> meterSmoothed;
-  float currentLevel { 0.0f };
+  std::array<ChannelDisplay, dsp::MeterFrame::kMaxChannels> channels;
+  int numChannels { 0 };
 };
 
+class ProGainAudioProcessorEditor::LoudnessReadout : public juce::Component, private juce::Timer
+{
+public:
+  explicit LoudnessReadout(ProGainAudioProcessor& proc)
+    : processor(proc)
+  {
+    for (auto* label : { &momentary, &shortTerm, &integrated, &truePeak })
+    {
+      label->setFont(juce::FontOptions(13.0f));
+      label->setColour(juce::Label::textColourId, juce::Colours::white);
+      label->setJustificationType(juce::Justification::centredLeft);
+      addAndMakeVisible(*label);
+    }
+
+    // Restart the integrated (programme) loudness measurement.
+    resetButton.onClick = [this]
+    {
+      processor.resetLoudness();
+      show(dsp::LoudnessFrame { kNoReading, kNoReading, kNoReading, kNoReading });
+    };
+    addAndMakeVisible(resetButton);
+
+    processor.popLoudnessFrame(latest); // drop anything stale
+    show(dsp::LoudnessFrame { kNoReading, kNoReading, kNoReading, kNoReading });
+    startTimerHz(10);
+  }
+
+  void resized() override
+  {
+    auto area = getLocalBounds();
+    resetButton.setBounds(area.removeFromRight(60));
+    const int width = area.getWidth() / 4;
+    momentary.setBounds(area.removeFromLeft(width));
+    shortTerm.setBounds(area.removeFromLeft(width));
+    integrated.setBounds(area.removeFromLeft(width + width / 2));
+    truePeak.setBounds(area);
+  }
+
+private:
+  static constexpr float kNoReading = -std::numeric_limits<float>::infinity();
+
+  void timerCallback() override
+  {
+    // Only the newest reading matters for display.
+    bool received = false;
+    while (processor.popLoudnessFrame(latest))
+      received = true;
+    if (received)
+      show(latest);
+  }
+
+  void show(const dsp::LoudnessFrame& frame)
+  {
+    auto format = [](float lufs)
+    {
+      return std::isfinite(lufs) ? juce::String(lufs, 1) : juce::String("-inf");
+    };
+    momentary.setText("M " + format(frame.momentary), juce::dontSendNotification);
+    shortTerm.setText("S " + format(frame.shortTerm), juce::dontSendNotification);
+    integrated.setText("I " + format(frame.integrated) + " LUFS", juce::dontSendNotification);
+    truePeak.setText("TP " + format(frame.truePeakMax), juce::dontSendNotification);
+  }
+
+  ProGainAudioProcessor& processor;
+  dsp::LoudnessFrame latest;
+  juce::Label momentary;
+  juce::Label shortTerm;
+  juce::Label integrated;
+  juce::Label truePeak;
+  juce::TextButton resetButton { "Reset" };
+};
+
+// Virtualized preset list. juce::ListBox only paints (and only creates row
+// components for) the rows in view. The factory presets (compiled into the
+// binary, see FactoryBank.h) come first, then the user presets from the
+// process-wide PresetLibrary's window, shared by every open editor and kept
+// up to date by it, so a save in one editor (or in another process) shows
+// up in all of them. The window starts at one page, newest first; as the
+// user scrolls towards its end the browser asks the library for the next
+// page.
+class ProGainAudioProcessorEditor::PresetBrowser : public juce::Component,
+                                                   private juce::ListBoxModel,
+                                                   private PresetLibrary::Listener
+{
+public:
+  explicit PresetBrowser(PresetLibrary& lib)
+    : library(lib)
+  {
+    list.setModel(this);
+    list.setRowHeight(kRowHeight);
+    list.setOutlineThickness(1);
+    list.setColour(juce::ListBox::backgroundColourId, juce::Colour::fromRGB(26, 30, 34));
+    list.setColour(juce::ListBox::outlineColourId, juce::Colour::fromRGB(48, 56, 64));
+    addAndMakeVisible(list);
+
+    library.addListener(this);
+  }
+
+  ~PresetBrowser() override
+  {
+    library.removeListener(this);
+    list.setModel(nullptr);
+  }
+
+  struct Selection
+  {
+    std::string name; // empty = nothing selected
+    bool factory { false };
+  };
+
+  // Runs with the preset on double-click.
+  std::function<void(const Selection&)> onOpen;
+
+  const Selection& getSelection() const
+  {
+    return selected;
+  }
+
+  // Selects the user preset `name` now if it is listed, otherwise as soon
+  // as it shows up (e.g. right after saving it).
+  void selectPreset(const std::string& name)
+  {
+    selected = { name, false };
+    reselect();
+  }
+
+  void resized() override
+  {
+    list.setBounds(getLocalBounds());
+  }
+
+private:
+  static constexpr int kRowHeight = 22;
+
+  static int numFactoryRows()
+  {
+    return (int) state::numFactoryPresets();
+  }
+
+  const PresetStore::PresetInfo* rowInfo(int row) const
+  {
+    const auto& presets = library.getPresets();
+    row -= numFactoryRows();
+    return juce::isPositiveAndBelow(row, (int) presets.size()) ? &presets[(size_t) row] : nullptr;
+  }
+
+  Selection rowSelection(int row) const
+  {
+    if (juce::isPositiveAndBelow(row, numFactoryRows()))
+      return { state::getFactoryPreset((size_t) row).name, true };
+    if (const auto* info = rowInfo(row))
+      return { info->name, false };
+    return {};
+  }
+
+  int getNumRows() override
+  {
+    // One placeholder row at the end until the first page has arrived, and
+    // while more pages exist.
+    const bool placeholder = !library.isLoaded() || library.hasMore();
+    return numFactoryRows() + (int) library.getPresets().size() + (placeholder ? 1 : 0);
+  }
+
+  void paintListBoxItem(int row, juce::Graphics& g, int width, int height, bool isSelected) override
+  {
+    if (isSelected)
+      g.fillAll(juce::Colour::fromRGB(48, 56, 64));
+
+    g.setFont(juce::FontOptions(14.0f));
+    auto area = juce::Rectangle<int>(0, 0, width, height).reduced(8, 0);
+
+    if (juce::isPositiveAndBelow(row, numFactoryRows()))
+    {
+      const auto& preset = state::getFactoryPreset((size_t) row);
+      g.setColour(juce::Colour::fromRGB(64, 196, 92).withAlpha(0.7f));
+      g.drawText("Factory", area.removeFromRight(width / 3), juce::Justification::centredRight, true);
+      g.setColour(juce::Colours::white);
+      g.drawText(juce::String::fromUTF8(preset.name), area, juce::Justification::centredLeft, true);
+      return;
+    }
+
+    const auto* info = rowInfo(row);
+    if (info == nullptr)
+    {
+      g.setColour(juce::Colours::white.withAlpha(0.4f));
+      g.drawText("Loading...", area, juce::Justification::centredLeft, true);
+      return;
+    }
+
+    g.setColour(juce::Colours::white.withAlpha(0.45f));
+    g.drawText(juce::String::fromUTF8(info->tags.c_str()), area.removeFromRight(width / 3),
+               juce::Justification::centredRight, true);
+    g.setColour(juce::Colours::white);
+    g.drawText(juce::String::fromUTF8(info->name.c_str()), area, juce::Justification::centredLeft, true);
+  }
+
+  void selectedRowsChanged(int row) override
+  {
+    // Rows move when the library changes; remember the name, not the row.
+    if (!updating && row >= 0)
+      selected = rowSelection(row);
+  }
+
+  void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override
+  {
+    const auto selection = rowSelection(row);
+    if (onOpen && !selection.name.empty())
+      onOpen(selection);
+  }
+
+  void listWasScrolled() override
+  {
+    fetchIfNeeded();
+  }
+
+  // Keeps about half a page loaded beyond the bottom of the view. The
+  // library ignores requests it already covers or is working on.
+  void fetchIfNeeded()
+  {
+    if (!library.hasMore())
+      return;
+
+    auto* viewport = list.getViewport();
+    const int lastVisibleRow = (viewport->getViewPositionY() + viewport->getViewHeight()) / kRowHeight;
+    library.ensureLoaded(lastVisibleRow - numFactoryRows() + PresetLibrary::kPageSize / 2);
+  }
+
+  void presetLibraryChanged(const PresetLibrary::Change&) override
+  {
+    {
+      const juce::ScopedValueSetter<bool> guard(updating, true);
+      list.updateContent();
+    }
+    list.repaint();
+    reselect();
+    fetchIfNeeded();
+  }
+
+  void reselect()
+  {
+    const juce::ScopedValueSetter<bool> guard(updating, true);
+    int row = -1;
+    if (selected.factory)
+    {
+      if (const auto* preset = state::findFactoryPreset(selected.name))
+        row = (int) (preset - &state::getFactoryPreset(0));
+    }
+    else if (!selected.name.empty())
+    {
+      const int index = library.indexOf(selected.name);
+      row = index < 0 ? -1 : numFactoryRows() + index;
+    }
+
+    if (row >= 0)
+      list.selectRow(row);
+    else
+      list.deselectAllRows();
+  }
+
+  PresetLibrary& library;
+  juce::ListBox list;
+  Selection selected;
+  bool updating { false };
+};
+
+#if PROGAIN_PROFILING
+class ProGainAudioProcessorEditor::CpuLoadOverlay : public juce::Label, private juce::Timer
+{
+public:
+  explicit CpuLoadOverlay(ProGainAudioProcessor& proc)
+    : processor(proc)
+  {
+    setFont(juce::FontOptions(11.0f));
+    setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(0.6f));
+    setJustificationType(juce::Justification::centredLeft);
+    startTimerHz(2);
+  }
+
+private:
+  void timerCallback() override
+  {
+    // Percentiles are read from the processor's lock-free histogram.
+    const auto stats = processor.getCpuLoadStats();
+    auto percent = [](float load) { return juce::String(load * 100.0f, 2) + "%"; };
+    setText("CPU p50 " + percent(stats.p50)
+              + "  p99 " + percent(stats.p99)
+              + "  max " + percent(stats.max),
+            juce::dontSendNotification);
+  }
+
+  ProGainAudioProcessor& processor;
+};
+#endif
+
 ProGainAudioProcessorEditor::ProGainAudioProcessorEditor(ProGainAudioProcessor& p)
   : AudioProcessorEditor(&p), processor(p)
 {
   // Basic layout size.
-  setSize(520, 300);
+  setSize(520, 500);
 
   // Gain knob styling.
   gainSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
@@ -91,7 +462,7 @@ ProGainAudioProcessorEditor::ProGainAudioProcessorEditor(ProGainAudioProcessor&
   // Wire the knob to the APVTS parameter.
   gainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
     processor.getAPVTS(),
-    kParamGainId,
+    params::kGain.id(),
     gainSlider
   );
 
@@ -110,7 +481,7 @@ ProGainAudioProcessorEditor::ProGainAudioProcessorEditor(ProGainAudioProcessor&
 
   trimAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
     processor.getAPVTS(),
-    kParamTrimId,
+    params::kTrim.id(),
     trimSlider
   );
 
@@ -118,6 +489,34 @@ ProGainAudioProcessorEditor::ProGainAudioProcessorEditor(ProGainAudioProcessor&
   meter = std::make_unique<MeterComponent>(processor);
   addAndMakeVisible(*meter);
 
+  loudness = std::make_unique<LoudnessReadout>(processor);
+  addAndMakeVisible(*loudness);
+
+  // Per-instance switch for the 4x true-peak detector.
+  truePeakButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+  truePeakButton.setTooltip("4x oversampled true-peak metering (BS.1770)");
+  addAndMakeVisible(truePeakButton);
+  truePeakAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+    processor.getAPVTS(),
+    params::kTruePeak.id(),
+    truePeakButton
+  );
+
+  // The same switch the host's bypass button drives.
+  bypassButton.setColour(juce::ToggleButton::textColourId, juce::Colours::white);
+  bypassButton.setTooltip("Fade to unity and pass the audio through (the level meter keeps running)");
+  addAndMakeVisible(bypassButton);
+  bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+    processor.getAPVTS(),
+    params::kBypass.id(),
+    bypassButton
+  );
+
+#if PROGAIN_PROFILING
+  cpuOverlay = std::make_unique<CpuLoadOverlay>(processor);
+  addAndMakeVisible(*cpuOverlay);
+#endif
+
   // Preset UI.
   presetName.setText("My Preset");
   presetName.setColour(juce::TextEditor::textColourId, juce::Colours::white);
@@ -129,95 +528,67 @@ ProGainAudioProcessorEditor::ProGainAudioProcessorEditor(ProGainAudioProcessor&
   addAndMakeVisible(loadPresetButton);
   addAndMakeVisible(deletePresetButton);
 
-  addAndMakeVisible(presetList);
-  presetList.setJustificationType(juce::Justification::centredLeft);
-  presetList.setColour(juce::ComboBox::backgroundColourId, juce::Colour::fromRGB(26, 30, 34));
-  presetList.setColour(juce::ComboBox::textColourId, juce::Colours::white);
-
-  auto refreshPresetList = [this]() {
-    presetList.clear();
-#if USE_SQLITE
-    PresetStore store;
-    auto dbFile = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
-                    .getChildFile("AbeAudio")
-                    .getChildFile("ProGain")
-                    .getChildFile("presets.db");
-    dbFile.getParentDirectory().createDirectory();
-    if (store.open(dbFile.getFullPathName().toStdString()))
-    {
-      const auto names = store.listPresets();
-      int itemId = 1;
-      for (const auto& name : names)
-        presetList.addItem(name, itemId++);
-    }
-#endif
-  };
-
-  savePresetButton.onClick = [this, refreshPresetList]() {
-#if USE_SQLITE
-    PresetStore store;
-    auto dbFile = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
-                    .getChildFile("AbeAudio")
-                    .getChildFile("ProGain")
-                    .getChildFile("presets.db");
-    dbFile.getParentDirectory().createDirectory();
-    if (!store.open(dbFile.getFullPathName().toStdString()))
-      return;
+  presetBrowser = std::make_unique<PresetBrowser>(processor.getPresetLibrary());
+  presetBrowser->onOpen = [this](const PresetBrowser::Selection& preset) { loadPreset(preset.name, preset.factory); };
+  addAndMakeVisible(*presetBrowser);
 
+  // All preset I/O runs on the shared library's worker thread. Callbacks
+  // come back on the message thread; SafePointer covers the editor closing
+  // before they arrive. Save/delete go through the library, which updates
+  // the browser of every open editor.
+  savePresetButton.onClick = [this]() {
     const auto name = presetName.getText().trim().toStdString();
     if (name.empty())
       return;
 
-    const auto blob = processor.exportPresetBlob();
-    store.savePreset(name, blob);
-    refreshPresetList();
-#endif
+    presetBrowser->selectPreset(name);
+    processor.getPresetLibrary().savePreset(name, processor.exportPresetBlob());
   };
 
   loadPresetButton.onClick = [this]() {
-#if USE_SQLITE
-    PresetStore store;
-    auto dbFile = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
-                    .getChildFile("AbeAudio")
-                    .getChildFile("ProGain")
-                    .getChildFile("presets.db");
-    if (!store.open(dbFile.getFullPathName().toStdString()))
-      return;
-
-    const auto name = presetList.getText().trim().toStdString();
-    if (name.empty())
-      return;
-
-    std::string blob;
-    if (store.loadPreset(name, blob))
-      processor.importPresetBlob(blob);
-#endif
+    const auto& selection = presetBrowser->getSelection();
+    loadPreset(selection.name, selection.factory);
   };
 
-  deletePresetButton.onClick = [this, refreshPresetList]() {
-#if USE_SQLITE
-    PresetStore store;
-    auto dbFile = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
-                    .getChildFile("AbeAudio")
-                    .getChildFile("ProGain")
-                    .getChildFile("presets.db");
-    if (!store.open(dbFile.getFullPathName().toStdString()))
+  deletePresetButton.onClick = [this]() {
+    // Factory presets are part of the plugin, not the library.
+    const auto& selection = presetBrowser->getSelection();
+    if (selection.name.empty() || selection.factory)
       return;
 
-    const auto name = presetList.getText().trim().toStdString();
-    if (name.empty())
-      return;
-
-    store.deletePreset(name);
-    refreshPresetList();
-#endif
+    processor.getPresetLibrary().deletePreset(selection.name);
   };
 
-  refreshPresetList();
+  // setSize() ran before the meter/readout/browser existed.
+  resized();
 }
 
 ProGainAudioProcessorEditor::~ProGainAudioProcessorEditor() = default;
 
+void ProGainAudioProcessorEditor::loadPreset(const std::string& name, bool factory)
+{
+  if (name.empty())
+    return;
+
+  // A newer load supersedes one that hasn't finished yet.
+  auto& worker = processor.getPresetWorker();
+  worker.cancel(pendingLoadTicket);
+
+  // Factory presets are in memory already: no worker round-trip.
+  if (factory)
+  {
+    if (const auto* preset = state::findFactoryPreset(name))
+      processor.loadFactoryPreset(*preset);
+    return;
+  }
+
+  juce::Component::SafePointer<ProGainAudioProcessorEditor> safeThis(this);
+  pendingLoadTicket = worker.loadPreset(name, [safeThis](bool found, const std::string& blob) {
+    if (safeThis != nullptr && found)
+      safeThis->processor.importPresetBlob(blob);
+  });
+}
+
 void ProGainAudioProcessorEditor::paint(juce::Graphics& g)
 {
   // Subtle gradient background and a frame.
@@ -235,11 +606,34 @@ void ProGainAudioProcessorEditor::paint(juce::Graphics& g)
   g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(10.0f), 16.0f, 1.0f);
 }
 
+#if PROGAIN_OVERRUN_MONITOR
+void ProGainAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
+{
+  if (!event.mods.isPopupMenu())
+    return;
+
+  // Lets users attach overrun data from a live session to a bug report.
+  juce::PopupMenu menu;
+  menu.addItem("Copy performance report", [this]
+  {
+    juce::SystemClipboard::copyTextToClipboard(processor.getOverrunReport());
+  });
+  menu.addItem("Reset performance counters", [this] { processor.resetOverrunStats(); });
+  menu.showMenuAsync(juce::PopupMenu::Options());
+}
+#endif
+
 void ProGainAudioProcessorEditor::resized()
 {
   // Lay out the meter on the right and the knob on the left.
   auto bounds = getLocalBounds().reduced(24);
 
+#if PROGAIN_PROFILING
+  // Sits in the top margin so it never covers the controls.
+  if (cpuOverlay)
+    cpuOverlay->setBounds(bounds.getX(), 4, bounds.getWidth(), 16);
+#endif
+
   auto meterArea = bounds.removeFromRight(60);
   if (meter)
     meter->setBounds(meterArea);
@@ -255,15 +649,23 @@ void ProGainAudioProcessorEditor::resized()
   trimSlider.setBounds(trimArea.removeFromTop(160).withSizeKeepingCentre(160, 160));
   trimLabel.setBounds(trimSlider.getX(), trimSlider.getBottom(), trimSlider.getWidth(), 20);
 
+  auto loudnessRow = bounds.removeFromTop(24);
+  bypassButton.setBounds(loudnessRow.removeFromRight(76));
+  truePeakButton.setBounds(loudnessRow.removeFromRight(56));
+  if (loudness)
+    loudness->setBounds(loudnessRow);
+
   auto presetArea = bounds;
   presetArea.removeFromTop(10);
-  presetName.setBounds(presetArea.removeFromTop(28));
+  auto nameRow = presetArea.removeFromTop(28);
+  savePresetButton.setBounds(nameRow.removeFromRight(100));
+  nameRow.removeFromRight(8);
+  presetName.setBounds(nameRow);
   presetArea.removeFromTop(8);
-  presetList.setBounds(presetArea.removeFromTop(28));
-  presetArea.removeFromTop(8);
-  auto buttonRow = presetArea.removeFromTop(28);
-  savePresetButton.setBounds(buttonRow.removeFromLeft(100));
-  buttonRow.removeFromLeft(8);
+  auto buttonRow = presetArea.removeFromBottom(28);
+  presetArea.removeFromBottom(8);
+  if (presetBrowser)
+    presetBrowser->setBounds(presetArea);
   loadPresetButton.setBounds(buttonRow.removeFromLeft(100));
   buttonRow.removeFromLeft(8);
   deletePresetButton.setBounds(buttonRow.removeFromLeft(100));
@@ -11,7 +11,12 @@
   Key ideas:
   - UI runs on a separate thread. It must never touch audio buffers directly.
   - Parameters are connected with APVTS attachments.
-  - The meter polls the processor's atomic meterLevel at ~30 FPS.
+  - The meter drains the processor's meter frames (peak/RMS/clips per
+    channel) at ~30 FPS; the loudness readout drains LUFS frames.
+  - The preset browser is a virtualized view of the built-in factory
+    presets followed by the process-wide preset library (PresetLibrary),
+    which keeps every open editor up to date.
+  - Right-clicking the background copies the overrun report (if built in).
 */
 class ProGainAudioProcessorEditor : public juce::AudioProcessorEditor
 {
@@ -21,6 +26,9 @@ public:
 
   void paint(juce::Graphics&) override;
   void resized() override;
+#if PROGAIN_OVERRUN_MONITOR
+  void mouseDown(const juce::MouseEvent&) override;
+#endif
 
 private:
   ProGainAudioProcessor& processor;
@@ -37,10 +45,29 @@ private:
   juce::TextButton savePresetButton { "Save" };
   juce::TextButton loadPresetButton { "Load" };
   juce::TextButton deletePresetButton { "Delete" };
-  juce::ComboBox presetList;
+  PresetWorker::Ticket pendingLoadTicket { 0 };
+
+  class PresetBrowser;
+  std::unique_ptr<PresetBrowser> presetBrowser;
+  void loadPreset(const std::string& name, bool factory);
 
   class MeterComponent;
   std::unique_ptr<MeterComponent> meter;
 
+  class LoudnessReadout;
+  std::unique_ptr<LoudnessReadout> loudness;
+
+  juce::ToggleButton truePeakButton { "TP" };
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> truePeakAttachment;
+
+  juce::ToggleButton bypassButton { "Bypass" };
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment;
+
+#if PROGAIN_PROFILING
+  // Debug overlay: per-instance CPU load (p50 / p99 / max).
+  class CpuLoadOverlay;
+  std::unique_ptr<CpuLoadOverlay> cpuOverlay;
+#endif
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProGainAudioProcessorEditor)
 };
@@ -5,18 +5,60 @@
 
   Walkthrough:
   - The gain parameter is read atomically each block.
-  - We smooth gain changes to avoid clicks.
-  - We compute a peak meter and store it atomically for the UI.
-  - We provide helpers to serialize/restore parameter state for presets.
+  - We smooth gain + trim changes together (in the gain domain) to avoid
+    clicks without a pow() per sample.
+  - Each channel is processed in one fused pass (gain + peak) by the
+    kernels in kernel/dsp/GainKernels. Float and double buffers share
+    one templated path (processSamples) and kernels of their own type.
+  - Fast paths: a digitally silent block skips the gain stage (and, once
+    the meter filters have rung out, the meter math too); a settled unity
+    gain only scans for the meters and never writes the buffer.
+  - Bypass (the "bypass" parameter or the host's processBlockBypassed())
+    fades the gain to unity, then passes the audio through untouched.
+  - Meter frames (peak/RMS/clips) and loudness readings go to the UI
+    through lock-free rings.
+  - State and presets use the compact binary format in
+    infra/state/StateCodec; legacy XML state still loads.
+  - Restoring state publishes one parameter snapshot to the audio thread
+    (infra/state/SnapshotExchange), so a preset switch is never half
+    applied.
 */
 #include "PluginProcessor.h"
 
 #include "PluginEditor.h"
+#include "infra/diagnostics/RealtimeSafety.h"
 #include "infra/parameters/ParameterRegistry.h"
+#include "infra/state/StateCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 namespace {
-constexpr const char* kParamGainId = "gain";
-constexpr const char* kParamTrimId = "trim";
+// BS.1770 weight of one output channel for the loudness meter: surrounds
+// count 1.41x, the LFE is left out. Ambisonic buses are measured on the
+// omni (W) channel only.
+double loudnessWeight(const juce::AudioChannelSet& set, int channel) {
+    if (set.getAmbisonicOrder() >= 0) return channel == 0 ? 1.0 : 0.0;
+
+    switch (set.getTypeOfChannel(channel)) {
+        case juce::AudioChannelSet::LFE:
+        case juce::AudioChannelSet::LFE2:
+            return 0.0;
+        case juce::AudioChannelSet::leftSurround:
+        case juce::AudioChannelSet::rightSurround:
+        case juce::AudioChannelSet::leftSurroundSide:
+        case juce::AudioChannelSet::rightSurroundSide:
+        case juce::AudioChannelSet::leftSurroundRear:
+        case juce::AudioChannelSet::rightSurroundRear:
+            return 1.41;
+        default:
+            return 1.0;
+    }
+}
 }  // namespace
 
 ProGainAudioProcessor::ProGainAudioProcessor()
@@ -24,7 +66,22 @@ ProGainAudioProcessor::ProGainAudioProcessor()
           BusesProperties()
               .withInput("Input", juce::AudioChannelSet::stereo(), true)
               .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts(*this, nullptr, "PARAMS", createParameterLayout()) {}
+      apvts(*this, nullptr, "PARAMS", createParameterLayout()),
+      gainParam(apvts, params::kGain),
+      trimParam(apvts, params::kTrim),
+      truePeakParam(apvts, params::kTruePeak),
+      bypassParam(apvts, params::kBypass) {
+    // Every id string is looked up here, once; nothing after this does.
+    const auto& specs = params::getAll();
+    for (size_t i = 0; i < specs.size(); ++i) {
+        parameters[i] = apvts.getParameter(specs[i].id);
+        rawValues[i] = apvts.getRawParameterValue(specs[i].id);
+        jassert(parameters[i] != nullptr && rawValues[i] != nullptr);
+    }
+#if PROGAIN_REFERENCE_KERNELS
+    useReferenceKernels.store(true);
+#endif
+}
 
 ProGainAudioProcessor::~ProGainAudioProcessor() = default;
 
@@ -35,6 +92,9 @@ const juce::String ProGainAudioProcessor::getName() const {
 bool ProGainAudioProcessor::acceptsMidi() const { return false; }
 bool ProGainAudioProcessor::producesMidi() const { return false; }
 bool ProGainAudioProcessor::isMidiEffect() const { return false; }
+// Output stops the moment input does (the gain ramp scales the input, it
+// doesn't generate anything), so hosts may stop calling processBlock() on a
+// silent track right away. The meters' filter ringing is not output.
 double ProGainAudioProcessor::getTailLengthSeconds() const { return 0.0; }
 
 int ProGainAudioProcessor::getNumPrograms() { return 1; }
@@ -43,72 +103,302 @@ void ProGainAudioProcessor::setCurrentProgram(int) {}
 const juce::String ProGainAudioProcessor::getProgramName(int) { return {}; }
 void ProGainAudioProcessor::changeProgramName(int, const juce::String&) {}
 
-void ProGainAudioProcessor::prepareToPlay(double sampleRate, int) {
-    // Smoothing time (seconds) for gain changes.
-    const auto* spec = params::find(kParamGainId);
-    gainSmoothed.reset(sampleRate, spec ? spec->smoothingSeconds : 0.02f);
-    const auto* gainParam = apvts.getRawParameterValue(kParamGainId);
-    gainSmoothed.setCurrentAndTargetValue(gainParam->load());
-
-    const auto* trimSpec = params::find(kParamTrimId);
-    trimSmoothed.reset(sampleRate,
-                       trimSpec ? trimSpec->smoothingSeconds : 0.02f);
-    const auto* trimParam = apvts.getRawParameterValue(kParamTrimId);
-    trimSmoothed.setCurrentAndTargetValue(trimParam->load());
-
-    meterLevel.store(0.0f);
+void ProGainAudioProcessor::prepareToPlay(double sampleRate,
+                                          int samplesPerBlock) {
+    // Smoothing time (seconds) for gain and trim changes.
+    gainSmoother.reset(sampleRate, params::kGain.spec().smoothingSeconds,
+                       params::kTrim.spec().smoothingSeconds);
+    gainSmoother.setCurrentAndTargetValue(gainParam.load(), trimParam.load());
+
+    // CPUID lookup happens here, never on the audio thread.
+    simdKernels.store(&dsp::selectSimdKernels<float>());
+    simdKernels64.store(&dsp::selectSimdKernels<double>());
+
+    // Channel layout: pick the gain loop specialised for this many
+    // channels.
+    const auto outputSet = getChannelLayoutOfBus(false, 0);
+    preparedChannels =
+        juce::jmin(outputSet.size(), dsp::MeterFrame::kMaxChannels);
+    gainStage = dsp::selectGainStage<float>(preparedChannels);
+    gainStage64 = dsp::selectGainStage<double>(preparedChannels);
+    upmixMono = getTotalNumInputChannels() == 1 && preparedChannels > 1;
+
+    loudness.prepare(sampleRate);
+    for (int ch = 0; ch < preparedChannels; ++ch)
+        loudness.setChannelWeight(ch, loudnessWeight(outputSet, ch));
+    loudnessResetRequested.store(false);
+    truePeak.reset();
+    truePeakActive = false;
+    truePeakMax = 0.0f;
+
+#if PROGAIN_PROFILING
+    cpuLoad.requestReset();
+#endif
+#if PROGAIN_OVERRUN_MONITOR
+    overrunMonitor.prepare(sampleRate, samplesPerBlock);
+#else
+    juce::ignoreUnused(samplesPerBlock);
+#endif
 }
 
 void ProGainAudioProcessor::releaseResources() {}
 
 bool ProGainAudioProcessor::isBusesLayoutSupported(
     const BusesLayout& layouts) const {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any discrete, surround or ambisonic layout, the same in and out, plus
+    // mono in -> stereo out. Every channel gets the gain; the meters show
+    // the first kMaxChannels.
+    const auto& in = layouts.getMainInputChannelSet();
+    const auto& out = layouts.getMainOutputChannelSet();
+    if (out.isDisabled())
         return false;
 
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-
-    return true;
+    return in == out || (in == juce::AudioChannelSet::mono() &&
+                         out == juce::AudioChannelSet::stereo());
 }
 
 void ProGainAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                          juce::MidiBuffer&) {
+    processSamples(buffer, false);
+}
+
+void ProGainAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer,
+                                         juce::MidiBuffer&) {
+    processSamples(buffer, false);
+}
+
+juce::AudioProcessorParameter* ProGainAudioProcessor::getBypassParameter()
+    const {
+    return parameters[params::kBypass.index];
+}
+
+void ProGainAudioProcessor::processBlockBypassed(
+    juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+    processSamples(buffer, true);
+}
+
+void ProGainAudioProcessor::processBlockBypassed(
+    juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) {
+    processSamples(buffer, true);
+}
+
+template <typename Sample>
+const dsp::BasicGainKernels<Sample>& ProGainAudioProcessor::getKernels()
+    const {
+    if (useReferenceKernels.load(std::memory_order_relaxed))
+        return dsp::scalarKernels<Sample>();
+    if constexpr (std::is_same_v<Sample, double>)
+        return *simdKernels64.load(std::memory_order_relaxed);
+    else
+        return *simdKernels.load(std::memory_order_relaxed);
+}
+
+template <typename Sample>
+dsp::BasicGainStageFn<Sample> ProGainAudioProcessor::getGainStage() const {
+    if constexpr (std::is_same_v<Sample, double>)
+        return gainStage64;
+    else
+        return gainStage;
+}
+
+template <typename Sample>
+void ProGainAudioProcessor::processSamples(juce::AudioBuffer<Sample>& buffer,
+                                           bool hostBypassed) {
+    // No-op unless built with PROGAIN_RT_SAFETY: then any allocation or
+    // lock until the end of this function is reported.
+    PROGAIN_RT_SCOPE;
     juce::ScopedNoDenormals noDenormals;
 
+#if PROGAIN_PROFILING || PROGAIN_OVERRUN_MONITOR
+    const auto blockStart = std::chrono::steady_clock::now();
+#endif
+
     const int numSamples = buffer.getNumSamples();
     const int numChannels = buffer.getNumChannels();
 
-    // Atomically read the parameter once per block, then smooth per-sample.
-    const auto* gainParam = apvts.getRawParameterValue(kParamGainId);
-    gainSmoothed.setTargetValue(gainParam->load());
-    const auto* trimParam = apvts.getRawParameterValue(kParamTrimId);
-    trimSmoothed.setTargetValue(trimParam->load());
-
-    float blockPeak = 0.0f;
-    // Cache channel pointers once to avoid repeated lookups in the inner loop.
-    std::vector<float*> channelData;
-    channelData.reserve((size_t)numChannels);
-    for (int ch = 0; ch < numChannels; ++ch)
-        channelData.push_back(buffer.getWritePointer(ch));
-
-    for (int sample = 0; sample < numSamples; ++sample) {
-        const float g = gainSmoothed.getNextValue();
-        const float trimDb = trimSmoothed.getNextValue();
-        const float trim = juce::Decibels::decibelsToGain(trimDb);
-        const float total = g * trim;
-        for (int ch = 0; ch < numChannels; ++ch) {
-            float* data = channelData[(size_t)ch];
-            const float v = data[sample] * total;
-            data[sample] = v;
-            blockPeak = juce::jmax(blockPeak, std::abs(v));
+    // Read the parameters once per block; the smoother turns them into
+    // gain-domain ramps (no per-sample dB conversion). While a preset is
+    // being switched, every value comes from its snapshot instead, so all
+    // targets change together in this block. (A preset snapshot doesn't
+    // carry bypass; that one is always read live.)
+    const auto* snapshot = parameterSnapshots.acquire();
+    auto readParam = [snapshot](const auto& param) {
+        return snapshot && param.index() < snapshot->count
+                   ? param.fromRaw(snapshot->values[param.index()])
+                   : param.load();
+    };
+    const float gainValue = readParam(gainParam);
+    const float trimValue = readParam(trimParam);
+
+    // Bypass crossfades through the smoother: for a pure gain, fading from
+    // the processed to the dry signal is the gain ramping to exactly 1.0.
+    // Once it gets there the plugin is a true pass-through.
+    const bool bypassed = hostBypassed || readParam(bypassParam);
+    gainSmoother.setTargetValue(bypassed ? 1.0f : gainValue,
+                                bypassed ? 0.0f : trimValue);
+    const bool passThrough = bypassed && !gainSmoother.isSmoothing();
+
+    const auto& kernels = getKernels<Sample>();
+
+    // Mono in, stereo out: the host leaves the second channel undefined,
+    // so both outputs start from the one input.
+    if (upmixMono && numChannels > 1)
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+
+    // Every channel of the bus is processed; the first kMaxChannels are
+    // also metered (level, true peak, loudness).
+    const int activeChannels =
+        juce::jmin(numChannels, dsp::MeterFrame::kMaxChannels);
+    std::array<Sample*, dsp::MeterFrame::kMaxChannels> channelPointers{};
+    for (int ch = 0; ch < activeChannels; ++ch)
+        channelPointers[(size_t)ch] = buffer.getWritePointer(ch);
+
+    std::array<dsp::ChannelStats, dsp::MeterFrame::kMaxChannels> stats{};
+    const dsp::BasicGainBlock<Sample> gainBlock{
+        channelPointers.data(), activeChannels, numSamples, stats.data()};
+
+    // Fully bypassed: the buffer is left as it is and only scanned for the
+    // meter frame. Otherwise the gain loop specialised for the prepared
+    // channel count runs; a host that sends a different count still gets
+    // correct (generic) processing.
+    bool silent = false;
+    if (passThrough) {
+        for (int ch = 0; ch < activeChannels; ++ch)
+            kernels.measure(channelPointers[(size_t)ch], numSamples,
+                            stats[(size_t)ch]);
+    } else {
+        // Channels past kMaxChannels (buses wider than the meters) go
+        // through the generic loop in groups of kMaxChannels, each from the
+        // smoother state this block starts with; their statistics are
+        // dropped.
+        for (int first = activeChannels; first < numChannels;
+             first += dsp::MeterFrame::kMaxChannels) {
+            const int count =
+                juce::jmin(dsp::MeterFrame::kMaxChannels, numChannels - first);
+            std::array<Sample*, dsp::MeterFrame::kMaxChannels> groupPointers{};
+            for (int ch = 0; ch < count; ++ch)
+                groupPointers[(size_t)ch] = buffer.getWritePointer(first + ch);
+            std::array<dsp::ChannelStats, dsp::MeterFrame::kMaxChannels>
+                unmetered{};
+            auto groupSmoother = gainSmoother;
+            dsp::genericGainStage<Sample>()(
+                kernels, groupSmoother,
+                {groupPointers.data(), count, numSamples, unmetered.data()});
         }
+
+        const auto stage = activeChannels == preparedChannels
+                               ? getGainStage<Sample>()
+                               : dsp::genericGainStage<Sample>();
+        silent = stage(kernels, gainSmoother, gainBlock);
     }
 
-    // Push peak meter value to UI thread (atomic).
-    meterLevel.store(blockPeak);
+    // True peak of the output at 4x (paused while bypassed). Restart the
+    // FIR history whenever it resumes so stale samples never produce a
+    // false over.
+    const bool measureTruePeak = !passThrough && readParam(truePeakParam);
+    if (measureTruePeak && !truePeakActive)
+        truePeak.reset();
+    truePeakActive = measureTruePeak;
+
+    // Hand this block's meter frame to the UI (wait-free; dropped if the
+    // editor isn't draining).
+    if (numSamples > 0) {
+        dsp::MeterFrame frame;
+        frame.numChannels = activeChannels;
+        frame.numSamples = numSamples;
+        for (int ch = 0; ch < frame.numChannels; ++ch) {
+            const auto& channel = stats[(size_t)ch];
+            const Sample* output = channelPointers[(size_t)ch];
+            const float channelTruePeak =
+                !measureTruePeak ? 0.0f
+                : silent ? truePeak.processSilence(ch, output, numSamples,
+                                                   kernels)
+                         : truePeak.process(ch, output, numSamples, kernels);
+            truePeakMax = juce::jmax(truePeakMax, channelTruePeak);
+            frame.channels[(size_t)ch] = {
+                channel.peak,
+                std::sqrt(channel.sumSquares / (float)numSamples),
+                channel.clips, channelTruePeak};
+        }
+        meterFrames.push(frame);
+    }
+
+    // Loudness of what we output; publishes a frame every 100 ms. It holds
+    // while bypassed, so a disabled track costs only the meter scan.
+    if (loudnessResetRequested.exchange(false, std::memory_order_relaxed)) {
+        loudness.reset();
+        truePeakMax = 0.0f;
+    }
+    const auto* const* outputs = channelPointers.data();
+    if (!passThrough &&
+        (silent ? loudness.processSilence(outputs, activeChannels, numSamples)
+                : loudness.process(outputs, activeChannels, numSamples))) {
+        auto readings = loudness.getReadings();
+        readings.truePeakMax =
+            measureTruePeak && truePeakMax > 0.0f
+                ? juce::Decibels::gainToDecibels(truePeakMax, -1000.0f)
+                : -std::numeric_limits<float>::infinity();
+        loudnessFrames.push(readings);
+    }
+
+#if PROGAIN_PROFILING || PROGAIN_OVERRUN_MONITOR
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - blockStart;
+#endif
+
+#if PROGAIN_PROFILING
+    // Load = compute time / playback time of this block.
+    const double sampleRate = getSampleRate();
+    if (numSamples > 0 && sampleRate > 0.0)
+        cpuLoad.record((float)(elapsed.count() * sampleRate / numSamples));
+#endif
+
+#if PROGAIN_OVERRUN_MONITOR
+    diagnostics::OverrunMonitor::Block overrunBlock;
+    overrunBlock.numSamples = numSamples;
+    overrunBlock.gain = gainValue;
+    overrunBlock.trimDb = trimValue;
+    overrunBlock.seconds = (float)elapsed.count();
+    overrunMonitor.record(overrunBlock);
+#else
+    juce::ignoreUnused(gainValue, trimValue);
+#endif
+}
+
+juce::String ProGainAudioProcessor::getKernelDiagnostics() const {
+    // The table processBlock() actually uses for the host's precision.
+    const char* active = isUsingDoublePrecision()
+                             ? getKernels<double>().name
+                             : getKernels<float>().name;
+    return juce::String("kernels: ") + active +
+           (isUsingDoublePrecision() ? " (double)" : " (float)") + " | " +
+           dsp::describeSimdSupport();
+}
+
+#if PROGAIN_OVERRUN_MONITOR
+juce::String ProGainAudioProcessor::getOverrunReport() const {
+    const auto report = overrunMonitor.getReport();
+    auto toMs = [](double seconds) { return juce::String(seconds * 1000.0, 3); };
+
+    juce::String text;
+    text << JucePlugin_Name << " " << JucePlugin_VersionString << "\n"
+         << getKernelDiagnostics() << "\n"
+         << "sample rate: " << getSampleRate()
+         << " Hz | budget: " << toMs(report.budgetSeconds) << " ms\n"
+         << "blocks: " << (juce::int64)report.blocks
+         << " | overruns: " << (juce::int64)report.overruns << "\n"
+         << "worst blocks:\n";
+
+    for (int i = 0; i < report.numWorst; ++i) {
+        const auto& block = report.worst[(size_t)i];
+        text << "  #" << (juce::int64)block.index << ": " << block.numSamples
+             << " samples, " << toMs(block.seconds) << " ms, gain "
+             << juce::String(block.gain, 3) << ", trim "
+             << juce::String(block.trimDb, 2) << " dB\n";
+    }
+    return text;
 }
+#endif
 
 bool ProGainAudioProcessor::hasEditor() const { return true; }
 
@@ -117,17 +407,87 @@ juce::AudioProcessorEditor* ProGainAudioProcessor::createEditor() {
 }
 
 void ProGainAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    float values[state::kMaxParams];
+    const size_t count = readParameterValues(values);
+    destData.setSize(state::encodedSize(count));
+    state::encode(values, count, destData.getData());
 }
 
 void ProGainAudioProcessor::setStateInformation(const void* data,
                                                 int sizeInBytes) {
-    std::unique_ptr<juce::XmlElement> xmlState(
-        getXmlFromBinary(data, sizeInBytes));
-    if (xmlState && xmlState->hasTagName(apvts.state.getType()))
-        apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    restoreState(data, (size_t)juce::jmax(0, sizeInBytes), false);
+}
+
+size_t ProGainAudioProcessor::readParameterValues(float* values) const {
+    for (size_t i = 0; i < params::kNumParams; ++i)
+        values[i] = rawValues[i]->load();
+    return params::kNumParams;
+}
+
+bool ProGainAudioProcessor::restoreState(const void* data, size_t size,
+                                         bool isPreset) {
+    // Decode the whole preset here on the message thread into one
+    // immutable snapshot. Start from defaults so parameters missing from
+    // old data reset.
+    const auto& specs = params::getAll();
+    auto snapshot = std::make_unique<state::ParameterSnapshot>();
+    snapshot->count = isPreset ? params::kNumPresetParams : params::kNumParams;
+    auto& values = snapshot->values;
+    for (size_t i = 0; i < snapshot->count; ++i)
+        values[i] = specs[i].defaultValue;
+
+    if (state::isBinaryState(data, size)) {
+        if (!state::decode(data, size, values.data(), snapshot->count))
+            return false;
+    } else {
+        // Sessions and presets saved before the binary format:
+        // <PARAMS><PARAM id="gain" value="-6"/>...</PARAMS>
+        std::unique_ptr<juce::XmlElement> xmlState(
+            getXmlFromBinary(data, (int)size));
+        if (!xmlState || !xmlState->hasTagName(apvts.state.getType()))
+            return false;
+        for (size_t i = 0; i < snapshot->count; ++i) {
+            auto* child = xmlState->getChildByAttribute("id", specs[i].id);
+            if (child == nullptr)
+                continue;
+            // "nan"/"inf" parse too; keep the default instead, as decode()
+            // does for binary state.
+            const auto value = (float)child->getDoubleAttribute(
+                "value", specs[i].defaultValue);
+            if (std::isfinite(value))
+                values[i] = value;
+        }
+    }
+
+    publishSnapshot(std::move(snapshot));
+    return true;
+}
+
+void ProGainAudioProcessor::publishSnapshot(
+    std::unique_ptr<state::ParameterSnapshot> snapshot) {
+    auto& values = snapshot->values;
+
+    // Snap to what the parameters will actually hold (range, step), so the
+    // audio thread sees no jump when it switches back to reading them.
+    for (size_t i = 0; i < snapshot->count; ++i)
+        values[i] = parameters[i]->convertFrom0to1(
+            parameters[i]->convertTo0to1(values[i]));
+
+    // Copy the values out before ownership moves to the exchange.
+    std::array<float, state::kMaxParams> plain = values;
+    const size_t count = snapshot->count;
+
+    // From the next block on, processBlock() uses the snapshot: all
+    // smoothers retarget at once, however long the host/UI updates below
+    // take.
+    const uint32_t generation = parameterSnapshots.publish(std::move(snapshot));
+
+    for (size_t i = 0; i < count; ++i)
+        parameters[i]->setValueNotifyingHost(
+            parameters[i]->convertTo0to1(plain[i]));
+
+    // The parameters match the snapshot now; audio goes back to them.
+    parameterSnapshots.markSynced(generation);
 }
 
 ProGainAudioProcessor::APVTS::ParameterLayout
@@ -140,22 +500,34 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() {
 }
 
 std::string ProGainAudioProcessor::exportPresetBlob() {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    if (!xml) return {};
-
-    juce::MemoryBlock block;
-    copyXmlToBinary(*xml, block);
-    return std::string(static_cast<const char*>(block.getData()),
-                       block.getSize());
+    float values[state::kMaxParams];
+    readParameterValues(values);
+    // Preset parameters only: loading a preset never toggles bypass.
+    const size_t count = params::kNumPresetParams;
+    std::string blob(state::encodedSize(count), '\0');
+    state::encode(values, count, &blob[0]);
+    return blob;
 }
 
 bool ProGainAudioProcessor::importPresetBlob(const std::string& blob) {
     if (blob.empty()) return false;
+    return restoreState(blob.data(), blob.size(), true);
+}
 
-    auto xml = getXmlFromBinary(blob.data(), (int)blob.size());
-    if (!xml || !xml->hasTagName(apvts.state.getType())) return false;
+void ProGainAudioProcessor::loadFactoryPreset(
+    const state::FactoryPreset& preset) {
+    // Already plain values in registry order: nothing to decode.
+    auto snapshot = std::make_unique<state::ParameterSnapshot>();
+    snapshot->count = state::kFactoryParams;
+    std::copy(preset.values, preset.values + snapshot->count,
+              snapshot->values.begin());
+    publishSnapshot(std::move(snapshot));
+}
 
-    apvts.replaceState(juce::ValueTree::fromXml(*xml));
-    return true;
+PresetLibrary& ProGainAudioProcessor::getPresetLibrary() {
+    // Attached lazily so hosts scanning the plugin never start the thread or
+    // touch the database.
+    if (!presetLibrary)
+        presetLibrary = std::make_unique<juce::SharedResourcePointer<PresetLibrary>>();
+    return **presetLibrary;
 }
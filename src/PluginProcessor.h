@@ -2,6 +2,22 @@
 
 #include <JuceHeader.h>
 
+#include "infra/concurrency/SpscRing.h"
+#include "infra/diagnostics/LoadHistogram.h"
+#include "infra/diagnostics/OverrunMonitor.h"
+#include "infra/parameters/ParameterRegistry.h"
+#include "infra/state/FactoryBank.h"
+#include "infra/state/PresetLibrary.h"
+#include "infra/state/SnapshotExchange.h"
+#include "kernel/dsp/GainKernels.h"
+#include "kernel/dsp/GainSmoother.h"
+#include "kernel/dsp/GainStage.h"
+#include "kernel/dsp/LoudnessMeter.h"
+#include "kernel/dsp/MeterFrame.h"
+#include "kernel/dsp/TruePeakDetector.h"
+
+#include <array>
+#include <atomic>
 #include <string>
 
 /**
@@ -12,10 +28,16 @@
   Key ideas for beginners:
   - prepareToPlay() runs once before audio starts. Set up DSP here.
   - processBlock() runs for every audio buffer. Keep it real-time safe:
-    no allocations, no locks, no file I/O, no logging.
-  - Parameters are owned by APVTS (AudioProcessorValueTreeState) and are
-    accessed on the audio thread via getRawParameterValue().
-  - The meterLevel is a simple atomic that the UI reads.
+    no allocations, no locks, no file I/O, no logging. Build with
+    -DPROGAIN_RT_SAFETY=ON to have violations reported at runtime.
+  - Parameters are owned by APVTS (AudioProcessorValueTreeState). The audio
+    thread reads them through typed handles (params::Handle) that resolve
+    each value's atomic once, in the constructor.
+  - Metering goes out as one MeterFrame per block through a lock-free
+    SPSC ring; the editor drains it on its timer.
+  - The per-sample math lives in kernel/dsp/GainKernels (SIMD by default,
+    picked for the CPU in prepareToPlay(), with a scalar reference you can
+    switch to for comparison). Float and double buffers both run natively.
 */
 class ProGainAudioProcessor : public juce::AudioProcessor {
    public:
@@ -27,7 +49,20 @@ class ProGainAudioProcessor : public juce::AudioProcessor {
 
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
+    // Both precisions run the same templated path (processSamples) and the
+    // same kernels, so a 64-bit host never converts buffers around us.
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    // Bypass is the registry's "bypass" switch. Hosts that bypass without
+    // it call processBlockBypassed(); both fade to unity gain and then pass
+    // the audio through, doing only the meter scan.
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+    void processBlockBypassed(juce::AudioBuffer<float>&,
+                              juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<double>&,
+                              juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -50,11 +85,64 @@ class ProGainAudioProcessor : public juce::AudioProcessor {
     using APVTS = juce::AudioProcessorValueTreeState;
     APVTS& getAPVTS() { return apvts; }
 
-    float getMeterLevel() const { return meterLevel.load(); }
-
-    // Serialize current parameter state for saving presets.
+    // Message thread, single consumer (the editor). Returns false when no
+    // frame is queued. Frames not drained in time are dropped, never queued
+    // behind a lock.
+    bool popMeterFrame(dsp::MeterFrame& frame) { return meterFrames.pop(frame); }
+    void clearMeterFrames() { meterFrames.clear(); }
+
+    // LUFS readings (momentary / short-term / integrated), one frame per
+    // 100 ms. Same single-consumer rules as the meter frames.
+    bool popLoudnessFrame(dsp::LoudnessFrame& frame) {
+        return loudnessFrames.pop(frame);
+    }
+    // Restarts the integrated measurement on the next audio block.
+    void resetLoudness() { loudnessResetRequested.store(true); }
+
+    // Route processBlock() through the scalar reference kernels instead of
+    // the SIMD ones. Safe to call from any thread; used to A/B the output
+    // and CPU cost of the two paths.
+    void setUseReferenceKernels(bool shouldUseReference) {
+        useReferenceKernels.store(shouldUseReference);
+    }
+    bool isUsingReferenceKernels() const { return useReferenceKernels.load(); }
+
+    // Which kernel variant processBlock() runs and what the CPU offers,
+    // e.g. "kernels: avx2 | compiled: scalar sse2 avx2 avx512f | ...".
+    juce::String getKernelDiagnostics() const;
+
+#if PROGAIN_PROFILING
+    // Per-block CPU load (processBlock time / block duration) as p50/p99/max.
+    // Read from any thread; compiled out unless PROGAIN_PROFILING is set.
+    diagnostics::LoadHistogram::Stats getCpuLoadStats() const {
+        return cpuLoad.getStats();
+    }
+    void resetCpuLoadStats() { cpuLoad.requestReset(); }
+#endif
+
+#if PROGAIN_OVERRUN_MONITOR
+    // Deadline misses of processBlock() against the prepareToPlay() budget,
+    // plus the worst blocks seen. Read from any thread (message thread);
+    // the text form is meant to be pasted into bug reports.
+    diagnostics::OverrunMonitor::Report getOverrunStats() const {
+        return overrunMonitor.getReport();
+    }
+    juce::String getOverrunReport() const;
+    void resetOverrunStats() { overrunMonitor.requestReset(); }
+#endif
+
+    // Serialize current parameter state for saving presets (same binary
+    // format as the host session state; see infra/state/StateCodec.h).
     std::string exportPresetBlob();
     bool importPresetBlob(const std::string& blob);
+    // Built-in presets load straight from the binary (see FactoryBank.h).
+    void loadFactoryPreset(const state::FactoryPreset& preset);
+
+    // The process-wide preset library (SQLite, background I/O), attached on
+    // first use. Message thread only; results come back to the message
+    // thread asynchronously.
+    PresetLibrary& getPresetLibrary();
+    PresetWorker& getPresetWorker() { return getPresetLibrary().getWorker(); }
 
     // All parameters are declared in one place so the UI + processor stay in
     // sync.
@@ -62,9 +150,70 @@ class ProGainAudioProcessor : public juce::AudioProcessor {
 
    private:
     APVTS apvts;
-    std::atomic<float> meterLevel{0.0f};
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainSmoothed;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> trimSmoothed;
+    // ~0.7 s of frames at 48 kHz / 128-sample blocks; plenty for a 30 Hz UI.
+    concurrency::SpscRing<dsp::MeterFrame, 256> meterFrames;
+    // BS.1770 loudness of the output, measured on the audio thread.
+    dsp::LoudnessMeter loudness;
+    concurrency::SpscRing<dsp::LoudnessFrame, 64> loudnessFrames;
+    std::atomic<bool> loudnessResetRequested{false};
+    // 4x true-peak of the output (per-instance "truePeak" switch).
+    dsp::TruePeakDetector truePeak;
+    bool truePeakActive = false;
+    float truePeakMax = 0.0f; // since the last loudness reset
+    // Gain + trim smoothed together as one gain-domain ramp.
+    dsp::GainSmoother gainSmoother;
+    // Channel layout, fixed in prepareToPlay(): the gain loop specialised
+    // for the channel count, per sample type.
+    dsp::GainStageFn gainStage = dsp::genericGainStage<float>();
+    dsp::BasicGainStageFn<double> gainStage64 = dsp::genericGainStage<double>();
+    int preparedChannels = 0;
+    bool upmixMono = false;
+    std::atomic<bool> useReferenceKernels{false};
+    // SIMD variants chosen for this CPU in prepareToPlay().
+    std::atomic<const dsp::GainKernels*> simdKernels{&dsp::scalarKernels<float>()};
+    std::atomic<const dsp::GainKernels64*> simdKernels64{
+        &dsp::scalarKernels<double>()};
+
+#if PROGAIN_PROFILING
+    diagnostics::LoadHistogram cpuLoad;
+#endif
+#if PROGAIN_OVERRUN_MONITOR
+    diagnostics::OverrunMonitor overrunMonitor;
+#endif
+
+    // Shared by every ProGain instance in the process (see PresetLibrary.h).
+    std::unique_ptr<juce::SharedResourcePointer<PresetLibrary>> presetLibrary;
+
+    // Whole-preset handoff from restoreState() to processBlock().
+    state::SnapshotExchange parameterSnapshots;
+    // The parameters processBlock() reads; each also knows its position
+    // in a snapshot.
+    const params::Handle<float> gainParam;
+    const params::Handle<float> trimParam;
+    const params::Handle<bool> truePeakParam;
+    const params::Handle<bool> bypassParam;
+    // Every parameter in params::getAll() order, for state save/restore.
+    std::array<juce::RangedAudioParameter*, params::kNumParams> parameters{};
+    std::array<std::atomic<float>*, params::kNumParams> rawValues{};
+
+    // The body of every processBlock() / processBlockBypassed() overload.
+    template <typename Sample>
+    void processSamples(juce::AudioBuffer<Sample>& buffer, bool hostBypassed);
+    // Kernels and gain loop for Sample (float or double) as prepared.
+    template <typename Sample>
+    const dsp::BasicGainKernels<Sample>& getKernels() const;
+    template <typename Sample>
+    dsp::BasicGainStageFn<Sample> getGainStage() const;
+
+    // Plain parameter values in params::getAll() order; returns the count.
+    size_t readParameterValues(float* values) const;
+    // Binary state (StateCodec) or legacy APVTS XML. Message thread;
+    // decodes into a snapshot and publishes it before touching APVTS. A
+    // preset only sets the preset parameters (bypass stays as it is).
+    bool restoreState(const void* data, size_t size, bool isPreset);
+    // Snaps the values to each parameter's range/step, hands them to the
+    // audio thread in one go, then updates the APVTS parameters.
+    void publishSnapshot(std::unique_ptr<state::ParameterSnapshot> snapshot);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProGainAudioProcessor)
 };
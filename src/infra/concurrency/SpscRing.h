@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+  SpscRing
+  --------
+  Fixed-capacity, wait-free FIFO for exactly ONE producer thread and ONE
+  consumer thread (here: audio thread -> message thread).
+
+  - Storage is a std::array inside the object: nothing is allocated after
+    construction, so push() is safe on the audio thread.
+  - push() and pop() never wait. A full ring makes push() return false and
+    the item is dropped (the producer must never block on the UI).
+  - Each side keeps a cached copy of the other side's index and only
+    re-reads the shared atomic when the cache says the ring looks full or
+    empty. In the common case a push is one copy plus one release store.
+
+  Capacity must be a power of two; one slot is NOT wasted (indices run
+  freely and are masked on access).
+*/
+namespace concurrency
+{
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+public:
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscRing items are copied with plain assignment on the audio thread");
+
+  // Producer thread only.
+  bool push(const T& item)
+  {
+    const std::size_t head = writeIndex.load(std::memory_order_relaxed);
+    if (head - cachedReadIndex >= Capacity)
+    {
+      cachedReadIndex = readIndex.load(std::memory_order_acquire);
+      if (head - cachedReadIndex >= Capacity)
+        return false;
+    }
+
+    items[head & kMask] = item;
+    writeIndex.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only.
+  bool pop(T& item)
+  {
+    const std::size_t tail = readIndex.load(std::memory_order_relaxed);
+    if (tail == cachedWriteIndex)
+    {
+      cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+      if (tail == cachedWriteIndex)
+        return false;
+    }
+
+    item = items[tail & kMask];
+    readIndex.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only: drop everything queued so far.
+  void clear()
+  {
+    cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+    readIndex.store(cachedWriteIndex, std::memory_order_release);
+  }
+
+  static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+  static constexpr std::size_t kMask = Capacity - 1;
+
+  // Producer and consumer state live on separate cache lines so the two
+  // threads don't keep invalidating each other.
+  alignas(64) std::atomic<std::size_t> writeIndex { 0 };
+  std::size_t cachedReadIndex { 0 };
+
+  alignas(64) std::atomic<std::size_t> readIndex { 0 };
+  std::size_t cachedWriteIndex { 0 };
+
+  alignas(64) std::array<T, Capacity> items {};
+};
+}
@@ -0,0 +1,97 @@
+/**
+  LoadHistogram.cpp
+  -----------------
+  Bin math + percentile readout for the per-block CPU load histogram.
+*/
+#include "LoadHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace diagnostics
+{
+namespace
+{
+// Keep the top 4 mantissa bits (16 bins per octave).
+constexpr int kMantissaShift = 23 - 4;
+constexpr uint32_t kMinKey = (uint32_t) (127 + LoadHistogram::kMinExponent) << 4;
+
+uint32_t floatBits(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+}
+
+int LoadHistogram::binIndex(float load)
+{
+  if (!(load > 0.0f)) // also catches NaN
+    return 0;
+
+  const auto key = floatBits(load) >> kMantissaShift;
+  if (key <= kMinKey)
+    return 0;
+  return (int) std::min<uint32_t>(key - kMinKey, (uint32_t) kNumBins - 1);
+}
+
+float LoadHistogram::binValue(int index)
+{
+  const int octave = index / kBinsPerOctave + kMinExponent;
+  const int step = index % kBinsPerOctave;
+  return std::ldexp(1.0f + ((float) step + 0.5f) / (float) kBinsPerOctave, octave);
+}
+
+void LoadHistogram::record(float load)
+{
+  if (resetRequested.exchange(false, std::memory_order_relaxed))
+  {
+    for (auto& bin : bins)
+      bin.store(0, std::memory_order_relaxed);
+    maxLoad.store(0.0f, std::memory_order_relaxed);
+  }
+
+  // Single writer: load + store is enough and avoids a locked RMW.
+  auto& bin = bins[(size_t) binIndex(load)];
+  bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  if (load > maxLoad.load(std::memory_order_relaxed))
+    maxLoad.store(load, std::memory_order_relaxed);
+}
+
+void LoadHistogram::snapshot(Counts& counts, float& max) const
+{
+  for (size_t i = 0; i < bins.size(); ++i)
+    counts[i] = bins[i].load(std::memory_order_relaxed);
+  max = maxLoad.load(std::memory_order_relaxed);
+}
+
+LoadHistogram::Stats LoadHistogram::getStats() const
+{
+  Counts counts;
+  Stats stats;
+  snapshot(counts, stats.max);
+
+  for (auto count : counts)
+    stats.blocks += count;
+  if (stats.blocks == 0)
+    return stats;
+
+  auto percentile = [&](double fraction) {
+    const auto rank = (uint64_t) std::ceil(fraction * (double) stats.blocks);
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBins; ++i)
+    {
+      seen += counts[(size_t) i];
+      if (seen >= rank)
+        return std::min(binValue(i), stats.max);
+    }
+    return stats.max;
+  };
+
+  stats.p50 = percentile(0.50);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+}
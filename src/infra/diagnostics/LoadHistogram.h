@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+  LoadHistogram
+  -------------
+  Lock-free, fixed-size histogram of per-block CPU load, where
+  load = time spent in processBlock() / duration of the audio in the block.
+  1.0 (100%) means the block took as long to compute as it takes to play.
+
+  Threading:
+  - record() is called by the audio thread only (single writer). It is a
+    handful of relaxed atomic operations: no locks, no allocation.
+  - snapshot() / getStats() may be called from any other thread (the
+    editor's timer). They read the counters without stopping the writer, so
+    a snapshot can be a block or two out of date, which is fine for display.
+  - requestReset() asks the audio thread to clear the counters on its next
+    record(), so the writer never races a reader-side clear.
+
+  Bins are logarithmic: 16 per octave from 2^-14 (~0.006%) to 2^4 (1600%).
+  That keeps ~4% resolution whether the plugin uses 0.01% or 90% of the
+  budget. The bin index comes straight from the float's exponent and top
+  mantissa bits, so no log() is needed.
+*/
+namespace diagnostics
+{
+class LoadHistogram
+{
+public:
+  static constexpr int kBinsPerOctave = 16;
+  static constexpr int kMinExponent = -14;
+  static constexpr int kMaxExponent = 4;
+  static constexpr int kNumBins = (kMaxExponent - kMinExponent) * kBinsPerOctave;
+
+  struct Stats
+  {
+    uint64_t blocks { 0 };
+    float p50 { 0.0f };
+    float p99 { 0.0f };
+    float max { 0.0f };
+  };
+
+  using Counts = std::array<uint32_t, kNumBins>;
+
+  // Audio thread.
+  void record(float load);
+
+  // Any other thread.
+  void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+  void snapshot(Counts& counts, float& maxLoad) const;
+  Stats getStats() const;
+
+  // Representative load of a bin (its geometric centre).
+  static float binValue(int index);
+  static int binIndex(float load);
+
+private:
+  std::array<std::atomic<uint32_t>, kNumBins> bins {};
+  std::atomic<float> maxLoad { 0.0f };
+  std::atomic<bool> resetRequested { false };
+};
+}
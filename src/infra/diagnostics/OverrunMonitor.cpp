@@ -0,0 +1,104 @@
+/**
+  OverrunMonitor.cpp
+  ------------------
+  Deadline check + seqlocked worst-block slots.
+*/
+#include "OverrunMonitor.h"
+
+#include <algorithm>
+
+namespace diagnostics
+{
+void OverrunMonitor::prepare(double sampleRate, int samplesPerBlock)
+{
+  const double budget = sampleRate > 0.0 ? (double) samplesPerBlock / sampleRate : 0.0;
+  budgetSeconds.store(budget, std::memory_order_relaxed);
+  requestReset();
+}
+
+void OverrunMonitor::record(const Block& block)
+{
+  if (resetRequested.exchange(false, std::memory_order_relaxed))
+  {
+    for (auto& slot : slots)
+      writeSlot(slot, Block {});
+    worstSeconds.fill(0.0f);
+    blocks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+  }
+
+  // Single writer: load + store is enough and avoids a locked RMW.
+  Block entry = block;
+  entry.index = blocks.load(std::memory_order_relaxed);
+  blocks.store(entry.index + 1, std::memory_order_relaxed);
+
+  const double budget = budgetSeconds.load(std::memory_order_relaxed);
+  if (budget > 0.0 && (double) entry.seconds > budget)
+    overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+  // Replace the least-bad of the kept blocks if this one is worse.
+  const auto least = std::min_element(worstSeconds.begin(), worstSeconds.end());
+  if (entry.seconds <= *least)
+    return;
+
+  *least = entry.seconds;
+  writeSlot(slots[(size_t) (least - worstSeconds.begin())], entry);
+}
+
+void OverrunMonitor::writeSlot(Slot& slot, const Block& block)
+{
+  const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.index.store(block.index, std::memory_order_relaxed);
+  slot.numSamples.store(block.numSamples, std::memory_order_relaxed);
+  slot.gain.store(block.gain, std::memory_order_relaxed);
+  slot.trimDb.store(block.trimDb, std::memory_order_relaxed);
+  slot.seconds.store(block.seconds, std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool OverrunMonitor::readSlot(const Slot& slot, Block& block)
+{
+  // A few attempts is plenty: the writer touches a slot at most once per
+  // audio block.
+  for (int attempt = 0; attempt < 4; ++attempt)
+  {
+    const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1u)
+      continue;
+
+    block.index = slot.index.load(std::memory_order_relaxed);
+    block.numSamples = slot.numSamples.load(std::memory_order_relaxed);
+    block.gain = slot.gain.load(std::memory_order_relaxed);
+    block.trimDb = slot.trimDb.load(std::memory_order_relaxed);
+    block.seconds = slot.seconds.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == before)
+      return true;
+  }
+  return false;
+}
+
+OverrunMonitor::Report OverrunMonitor::getReport() const
+{
+  Report report;
+  report.blocks = blocks.load(std::memory_order_relaxed);
+  report.overruns = overruns.load(std::memory_order_relaxed);
+  report.budgetSeconds = budgetSeconds.load(std::memory_order_relaxed);
+
+  for (const auto& slot : slots)
+  {
+    Block block;
+    if (readSlot(slot, block) && block.numSamples > 0)
+      report.worst[(size_t) report.numWorst++] = block;
+  }
+
+  std::sort(report.worst.begin(), report.worst.begin() + report.numWorst,
+            [](const Block& a, const Block& b) { return a.seconds > b.seconds; });
+  return report;
+}
+}
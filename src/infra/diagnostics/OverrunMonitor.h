@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+  OverrunMonitor
+  --------------
+  Tells us when *our* processBlock() misses its deadline, independent of the
+  host. The budget is the length of a full block as announced in
+  prepareToPlay() (samplesPerBlock / sampleRate); a block that takes longer
+  than that to compute is an overrun.
+
+  Besides the overrun counter it keeps the worst kNumWorst blocks seen since
+  the last reset (block size, parameter values, duration), so a report from
+  a live session shows what the plugin was doing when it was slowest.
+
+  Threading:
+  - record() is called by the audio thread only (single writer). No locks,
+    no allocation; each worst-block slot is published with a seqlock.
+  - getReport() may be called from any other thread. It never blocks the
+    writer; if a slot is rewritten while being read, the read is retried.
+  - prepare() / requestReset() ask the audio thread to clear everything on
+    its next record(), so the writer never races a reader-side clear.
+*/
+namespace diagnostics
+{
+class OverrunMonitor
+{
+public:
+  static constexpr int kNumWorst = 8;
+
+  struct Block
+  {
+    uint64_t index { 0 };     // block number since the last reset
+    int numSamples { 0 };     // 0 = empty slot
+    float gain { 0.0f };      // parameter values at the start of the block
+    float trimDb { 0.0f };
+    float seconds { 0.0f };   // time spent in processBlock()
+  };
+
+  struct Report
+  {
+    uint64_t blocks { 0 };
+    uint64_t overruns { 0 };
+    double budgetSeconds { 0.0 };
+    int numWorst { 0 };
+    std::array<Block, kNumWorst> worst {}; // slowest first
+  };
+
+  // Message thread, while audio is stopped (prepareToPlay).
+  void prepare(double sampleRate, int samplesPerBlock);
+
+  // Audio thread.
+  void record(const Block& block);
+
+  // Any other thread.
+  void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+  Report getReport() const;
+
+private:
+  struct Slot
+  {
+    std::atomic<uint32_t> sequence { 0 }; // odd while being written
+    std::atomic<uint64_t> index { 0 };
+    std::atomic<int> numSamples { 0 };
+    std::atomic<float> gain { 0.0f };
+    std::atomic<float> trimDb { 0.0f };
+    std::atomic<float> seconds { 0.0f };
+  };
+
+  void writeSlot(Slot& slot, const Block& block);
+  static bool readSlot(const Slot& slot, Block& block);
+
+  std::array<Slot, kNumWorst> slots;
+  std::atomic<uint64_t> blocks { 0 };
+  std::atomic<uint64_t> overruns { 0 };
+  std::atomic<double> budgetSeconds { 0.0 };
+  std::atomic<bool> resetRequested { false };
+
+  // Writer-only copy of the slot durations, so finding the slot to replace
+  // never touches the shared atomics.
+  std::array<float, kNumWorst> worstSeconds {};
+};
+}
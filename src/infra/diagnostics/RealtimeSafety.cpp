@@ -0,0 +1,306 @@
+/**
+  RealtimeSafety.cpp
+  ------------------
+  Allocation / lock hooks for the real-time safety mode.
+
+  Everything below the public functions is only compiled when
+  PROGAIN_RT_SAFETY=1. The hooks are cheap when the calling thread is not
+  inside a ScopedAudioThread: one thread_local read.
+*/
+#include "RealtimeSafety.h"
+
+#include <atomic>
+
+#if PROGAIN_RT_SAFETY
+  #include <cstdio>
+  #include <cstdlib>
+  #include <cstring>
+  #include <new>
+
+  #if defined(__GLIBC__) || defined(__APPLE__)
+    #include <execinfo.h>
+    #include <unistd.h>
+    #define PROGAIN_RT_HAS_EXECINFO 1
+  #endif
+
+  #if defined(__GLIBC__)
+    #include <dlfcn.h>
+    #include <pthread.h>
+    #define PROGAIN_RT_HOOK_LIBC 1
+  #endif
+
+  #if defined(_WIN32)
+    #include <malloc.h>
+  #endif
+#endif
+
+namespace rtsafety
+{
+namespace
+{
+#if PROGAIN_RT_SAFETY_ABORT
+std::atomic<Policy> policy { Policy::abort };
+#else
+std::atomic<Policy> policy { Policy::report };
+#endif
+std::atomic<uint64_t> violations { 0 };
+
+#if PROGAIN_RT_SAFETY
+thread_local int audioDepth = 0;
+thread_local bool reporting = false;
+
+void printStackTrace()
+{
+  #if PROGAIN_RT_HAS_EXECINFO
+  void* frames[64];
+  const int count = backtrace(frames, 64);
+  // The _fd variant writes straight to the descriptor without malloc.
+  backtrace_symbols_fd(frames, count, STDERR_FILENO);
+  #else
+  std::fputs("  (stack trace not available on this platform)\n", stderr);
+  #endif
+}
+
+void onViolation(const char* what)
+{
+  if (audioDepth == 0 || reporting)
+    return;
+
+  // Reporting may itself allocate; never recurse into ourselves.
+  reporting = true;
+  violations.fetch_add(1, std::memory_order_relaxed);
+
+  std::fprintf(stderr, "[ProGain] real-time violation on audio thread: %s\n", what);
+  printStackTrace();
+  std::fflush(stderr);
+
+  if (policy.load(std::memory_order_relaxed) == Policy::abort)
+    std::abort();
+
+  reporting = false;
+}
+
+  #if PROGAIN_RT_HOOK_LIBC
+using MutexLockFn = int (*)(pthread_mutex_t*);
+std::atomic<MutexLockFn> realMutexLock { nullptr };
+
+MutexLockFn resolveMutexLock()
+{
+  const auto lock = reinterpret_cast<MutexLockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+  realMutexLock.store(lock, std::memory_order_release);
+  return lock;
+}
+  #endif
+
+// backtrace() loads libgcc lazily on first use, which allocates, and the
+// pthread_mutex_lock hook needs the real function from dlsym(). Do both at
+// startup (or when the plugin is loaded), not on the audio thread.
+struct WarmUp
+{
+  WarmUp()
+  {
+  #if PROGAIN_RT_HAS_EXECINFO
+    void* frame[1];
+    backtrace(frame, 1);
+  #endif
+  #if PROGAIN_RT_HOOK_LIBC
+    resolveMutexLock();
+  #endif
+  }
+} warmUp;
+#endif
+}
+
+void setPolicy(Policy newPolicy)
+{
+  policy.store(newPolicy);
+}
+
+Policy getPolicy()
+{
+  return policy.load();
+}
+
+uint64_t getViolationCount()
+{
+  return violations.load();
+}
+
+ScopedAudioThread::ScopedAudioThread()
+{
+#if PROGAIN_RT_SAFETY
+  ++audioDepth;
+#endif
+}
+
+ScopedAudioThread::~ScopedAudioThread()
+{
+#if PROGAIN_RT_SAFETY
+  --audioDepth;
+#endif
+}
+}
+
+#if PROGAIN_RT_SAFETY
+
+//==============================================================================
+// Raw allocation used by the operator new replacements. On glibc we call the
+// underlying allocator directly so an operator new shows up as one
+// violation, not two.
+  #if PROGAIN_RT_HOOK_LIBC
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void __libc_free(void*);
+extern "C" void* __libc_memalign(size_t, size_t);
+  #endif
+
+namespace
+{
+void* rawAlloc(std::size_t size)
+{
+  #if PROGAIN_RT_HOOK_LIBC
+  return __libc_malloc(size == 0 ? 1 : size);
+  #else
+  return std::malloc(size == 0 ? 1 : size);
+  #endif
+}
+
+void rawFree(void* ptr)
+{
+  #if PROGAIN_RT_HOOK_LIBC
+  __libc_free(ptr);
+  #else
+  std::free(ptr);
+  #endif
+}
+
+void* rawAlignedAlloc(std::size_t size, std::size_t alignment)
+{
+  #if defined(_WIN32)
+  return _aligned_malloc(size == 0 ? 1 : size, alignment);
+  #elif PROGAIN_RT_HOOK_LIBC
+  return __libc_memalign(alignment, size == 0 ? 1 : size);
+  #else
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size == 0 ? 1 : size) != 0)
+    return nullptr;
+  return ptr;
+  #endif
+}
+
+void rawAlignedFree(void* ptr)
+{
+  #if defined(_WIN32)
+  _aligned_free(ptr);
+  #else
+  rawFree(ptr);
+  #endif
+}
+
+void* checkedNew(std::size_t size)
+{
+  rtsafety::onViolation("operator new");
+  if (void* ptr = rawAlloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* checkedAlignedNew(std::size_t size, std::align_val_t alignment)
+{
+  rtsafety::onViolation("operator new (aligned)");
+  if (void* ptr = rawAlignedAlloc(size, static_cast<std::size_t>(alignment)))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void checkedDelete(void* ptr)
+{
+  if (ptr == nullptr)
+    return;
+  rtsafety::onViolation("operator delete");
+  rawFree(ptr);
+}
+
+void checkedAlignedDelete(void* ptr)
+{
+  if (ptr == nullptr)
+    return;
+  rtsafety::onViolation("operator delete (aligned)");
+  rawAlignedFree(ptr);
+}
+}
+
+void* operator new(std::size_t size) { return checkedNew(size); }
+void* operator new[](std::size_t size) { return checkedNew(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  rtsafety::onViolation("operator new (nothrow)");
+  return rawAlloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  rtsafety::onViolation("operator new[] (nothrow)");
+  return rawAlloc(size);
+}
+void* operator new(std::size_t size, std::align_val_t al) { return checkedAlignedNew(size, al); }
+void* operator new[](std::size_t size, std::align_val_t al) { return checkedAlignedNew(size, al); }
+
+void operator delete(void* ptr) noexcept { checkedDelete(ptr); }
+void operator delete[](void* ptr) noexcept { checkedDelete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { checkedDelete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { checkedDelete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { checkedDelete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { checkedDelete(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { checkedAlignedDelete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { checkedAlignedDelete(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { checkedAlignedDelete(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { checkedAlignedDelete(ptr); }
+
+//==============================================================================
+// C allocator + mutex hooks (glibc). These only see calls made from code
+// linked into this binary, which is exactly the audio path we care about.
+// In the dlopen()ed VST3 that relies on -Bsymbolic-functions (see
+// CMakeLists.txt); without it the plugin's calls resolve to libc first.
+  #if PROGAIN_RT_HOOK_LIBC
+extern "C"
+{
+void* malloc(size_t size)
+{
+  rtsafety::onViolation("malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+  rtsafety::onViolation("calloc");
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  rtsafety::onViolation("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+  if (ptr != nullptr)
+    rtsafety::onViolation("free");
+  __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+  auto lock = rtsafety::realMutexLock.load(std::memory_order_acquire);
+  // Only static initialisers that run before warmUp's get here.
+  if (lock == nullptr)
+    lock = rtsafety::resolveMutexLock();
+
+  rtsafety::onViolation("pthread_mutex_lock");
+  return lock(mutex);
+}
+}
+  #endif
+
+#endif
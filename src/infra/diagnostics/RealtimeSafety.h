@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+  RealtimeSafety
+  --------------
+  A debug/test build mode that catches real-time rule breaks on the audio
+  thread: heap allocation, freeing, and mutex locking.
+
+  Enable it with -DPROGAIN_RT_SAFETY=ON. processBlock() then marks the
+  calling thread with PROGAIN_RT_SCOPE; while that scope is alive, any
+  violation is reported to stderr with a stack trace (or aborts, see
+  setPolicy()).
+
+  What gets hooked:
+  - operator new/delete (all variants): every platform.
+  - malloc/calloc/realloc/free and pthread_mutex_lock: Linux (glibc) only.
+
+  The hooks see calls made by code linked into the same binary: ProGainBench,
+  the standalone app, or the VST3 (linked with -Bsymbolic-functions on Linux
+  so those calls bind to the hooks rather than the host's libc). Calls made
+  inside other shared libraries (libstdc++, the host) are not seen.
+
+  With the option OFF (the default) PROGAIN_RT_SCOPE expands to nothing and
+  none of the hooks are compiled, so release builds pay nothing.
+*/
+namespace rtsafety
+{
+enum class Policy
+{
+  report, // print + count, keep running
+  abort   // print, then std::abort() (useful under a debugger or in CI)
+};
+
+void setPolicy(Policy policy);
+Policy getPolicy();
+
+// Number of violations seen since startup (all threads).
+uint64_t getViolationCount();
+
+// Marks the current thread as running the audio callback. Nests.
+class ScopedAudioThread
+{
+public:
+  ScopedAudioThread();
+  ~ScopedAudioThread();
+
+  ScopedAudioThread(const ScopedAudioThread&) = delete;
+  ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+};
+}
+
+#if PROGAIN_RT_SAFETY
+  #define PROGAIN_RT_SCOPE rtsafety::ScopedAudioThread progainRtScope
+#else
+  #define PROGAIN_RT_SCOPE
+#endif
@@ -1,50 +1,18 @@
 /**
   ParameterRegistry.cpp
   ---------------------
-  Single source of truth for parameter metadata.
+  Turns the constexpr parameter list into JUCE parameters.
 
   Web-dev analogy:
   - Think of this like a JSON schema for your plugin's state.
   - UI, audio, and presets all read from this list so they stay in sync.
 */
 #include "ParameterRegistry.h"
-#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace params
 {
-namespace
-{
-const std::vector<ParamSpec> kParams = {
-  {
-    "gain",
-    "Gain",
-    0.0f,
-    2.0f,
-    0.001f,
-    0.5f,
-    1.0f,
-    "x",
-    0.02f
-  },
-  {
-    "trim",
-    "Output Trim",
-    -12.0f,
-    12.0f,
-    0.01f,
-    1.0f,
-    0.0f,
-    "dB",
-    0.02f
-  }
-};
-}
-
-const std::vector<ParamSpec>& getAll()
-{
-  return kParams;
-}
-
 juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
 {
   std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
@@ -52,6 +20,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
 
   for (const auto& spec : kParams)
   {
+    if (spec.type == ParamType::Toggle)
+    {
+      params.push_back(std::make_unique<juce::AudioParameterBool>(
+        spec.id,
+        spec.name,
+        spec.defaultValue >= 0.5f
+      ));
+      continue;
+    }
+
     auto range = juce::NormalisableRange<float>(spec.min, spec.max, spec.step, spec.skew);
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
       spec.id,
@@ -64,14 +42,4 @@ juce::AudioProcessorValueTreeState::ParameterLayout createLayout()
 
   return { params.begin(), params.end() };
 }
-
-const ParamSpec* find(const char* id)
-{
-  for (const auto& spec : kParams)
-  {
-    if (std::strcmp(spec.id, id) == 0)
-      return &spec;
-  }
-  return nullptr;
-}
 }
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include <string>
-#include <vector>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
 
 /**
   ParameterRegistry
@@ -12,9 +16,24 @@
   Web-dev analogy:
   - This is like a typed schema for your plugin's "config" object.
   - The UI, audio thread, and preset system all pull from this one source.
+
+  The list is a constexpr array, so everything about it (count, positions,
+  id hashes) is known at compile time:
+  - kGain / kTrim / kTruePeak / kBypass are typed keys (Param<float>, Param<bool>)
+    holding a parameter's position in the list. A typo'd id or a float key
+    for a switch fails the build.
+  - A Handle resolves a key to the APVTS value (std::atomic<float>*) once,
+    when the processor is constructed. Reading it on the audio thread is a
+    single atomic load: no string lookups, however many parameters exist.
 */
 namespace params
 {
+enum class ParamType
+{
+  Float,  // continuous knob (AudioParameterFloat)
+  Toggle  // on/off switch (AudioParameterBool); defaultValue >= 0.5 = on
+};
+
 struct ParamSpec
 {
   const char* id;
@@ -26,11 +45,177 @@ struct ParamSpec
   float defaultValue;
   const char* unit;
   float smoothingSeconds; // UI/processor default smoothing time
+  ParamType type = ParamType::Float;
+  // false for session-only switches (bypass): saved with the host
+  // session, but presets neither store nor change them.
+  bool inPresets = true;
 };
 
-const std::vector<ParamSpec>& getAll();
+inline constexpr std::array kParams {
+  ParamSpec {
+    "gain",
+    "Gain",
+    0.0f,
+    2.0f,
+    0.001f,
+    0.5f,
+    1.0f,
+    "x",
+    0.02f
+  },
+  ParamSpec {
+    "trim",
+    "Output Trim",
+    -12.0f,
+    12.0f,
+    0.01f,
+    1.0f,
+    0.0f,
+    "dB",
+    0.02f
+  },
+  ParamSpec {
+    "truePeak",
+    "True Peak Meter",
+    0.0f,
+    1.0f,
+    1.0f,
+    1.0f,
+    1.0f,
+    "",
+    0.0f,
+    ParamType::Toggle
+  },
+  // The host's bypass (getBypassParameter()). Fades through the gain
+  // smoother, so it has no smoothing time of its own.
+  ParamSpec {
+    "bypass",
+    "Bypass",
+    0.0f,
+    1.0f,
+    1.0f,
+    1.0f,
+    0.0f,
+    "",
+    0.0f,
+    ParamType::Toggle,
+    false
+  }
+};
+inline constexpr size_t kNumParams = kParams.size();
 
-juce::AudioProcessorValueTreeState::ParameterLayout createLayout();
+// Preset parameters come first, so a preset is always the leading
+// kNumPresetParams values of the list.
+inline constexpr size_t kNumPresetParams = [] {
+  size_t count = 0;
+  while (count < kNumParams && kParams[count].inPresets)
+    ++count;
+  return count;
+}();
+static_assert([] {
+  for (size_t i = kNumPresetParams; i < kNumParams; ++i)
+    if (kParams[i].inPresets)
+      return false;
+  return true;
+}(), "list preset parameters before session-only ones");
+
+constexpr const auto& getAll()
+{
+  return kParams;
+}
 
-const ParamSpec* find(const char* id);
+// Stable 32-bit id for a parameter (FNV-1a of its id string), used by the
+// binary state format. constexpr, so known ids hash at compile time.
+constexpr uint32_t hashId(const char* id)
+{
+  uint32_t hash = 2166136261u;
+  while (*id != '\0')
+  {
+    hash ^= (uint8_t) *id++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// hashId() of every parameter, in list order.
+inline constexpr auto kIdHashes = [] {
+  std::array<uint32_t, kNumParams> hashes {};
+  for (size_t i = 0; i < kNumParams; ++i)
+    hashes[i] = hashId(kParams[i].id);
+  return hashes;
+}();
+
+// Position of `id` in the list, or kNumParams.
+constexpr size_t indexOf(std::string_view id)
+{
+  for (size_t i = 0; i < kNumParams; ++i)
+    if (id == kParams[i].id)
+      return i;
+  return kNumParams;
+}
+
+constexpr const ParamSpec* find(std::string_view id)
+{
+  const size_t index = indexOf(id);
+  return index < kNumParams ? &kParams[index] : nullptr;
+}
+
+// Typed, compile-time key for one parameter: float for knobs, bool for
+// switches.
+template <typename T>
+struct Param
+{
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, bool>, "float or bool parameters only");
+
+  size_t index;
+
+  constexpr const ParamSpec& spec() const { return kParams[index]; }
+  constexpr const char* id() const { return kParams[index].id; }
+
+  constexpr bool isValid() const
+  {
+    return index < kNumParams
+        && kParams[index].type == (std::is_same_v<T, bool> ? ParamType::Toggle : ParamType::Float);
+  }
+
+  // Raw APVTS value (0/1 for switches) to the parameter's type.
+  static constexpr T fromRaw(float raw)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+      return raw >= 0.5f;
+    else
+      return raw;
+  }
+};
+
+inline constexpr Param<float> kGain { indexOf("gain") };
+inline constexpr Param<float> kTrim { indexOf("trim") };
+inline constexpr Param<bool> kTruePeak { indexOf("truePeak") };
+inline constexpr Param<bool> kBypass { indexOf("bypass") };
+static_assert(kGain.isValid() && kTrim.isValid() && kTruePeak.isValid() && kBypass.isValid(),
+              "parameter key doesn't match the list (id or type)");
+
+// A parameter's live value, resolved once. Construct after the APVTS (on
+// the message thread); load() is safe on any thread.
+template <typename T>
+class Handle
+{
+public:
+  Handle(juce::AudioProcessorValueTreeState& apvts, Param<T> key)
+    : param(key), value(apvts.getRawParameterValue(key.id()))
+  {
+    jassert(value != nullptr);
+  }
+
+  size_t index() const { return param.index; }
+  float loadRaw() const { return value->load(); }
+  T load() const { return fromRaw(loadRaw()); }
+  static T fromRaw(float raw) { return Param<T>::fromRaw(raw); }
+
+private:
+  Param<T> param;
+  std::atomic<float>* value;
+};
+
+juce::AudioProcessorValueTreeState::ParameterLayout createLayout();
 }
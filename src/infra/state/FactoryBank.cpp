@@ -0,0 +1,138 @@
+/**
+  FactoryBank.cpp
+  ---------------
+  The factory preset table and its compile-time name index.
+*/
+#include "FactoryBank.h"
+#include "infra/parameters/ParameterRegistry.h"
+
+namespace state
+{
+namespace
+{
+// name, tags, { gain (x), trim (dB), truePeak (0/1) }. Keep sorted by name.
+constexpr FactoryPreset kPresets[] = {
+  { "Boost +3 dB",             "utility",            { 1.413f,  0.0f, 1.0f } },
+  { "Boost +6 dB",             "utility",            { 1.995f,  0.0f, 1.0f } },
+  { "Broadcast Headroom",      "loudness broadcast", { 1.0f,   -3.0f, 1.0f } },
+  { "Cut -12 dB",              "utility",            { 0.251f,  0.0f, 1.0f } },
+  { "Cut -18 dB",              "staging mixing",     { 0.126f,  0.0f, 1.0f } },
+  { "Cut -6 dB",               "utility",            { 0.501f,  0.0f, 1.0f } },
+  { "Low CPU (No True Peak)",  "utility",            { 1.0f,    0.0f, 0.0f } },
+  { "Mute",                    "utility",            { 0.0f,    0.0f, 1.0f } },
+  { "Trim -1 dB",              "staging",            { 1.0f,   -1.0f, 1.0f } },
+  { "Trim -6 dB",              "staging",            { 1.0f,   -6.0f, 1.0f } },
+  { "Unity",                   "utility default",    { 1.0f,    0.0f, 1.0f } }
+};
+constexpr size_t kNumPresets = sizeof(kPresets) / sizeof(kPresets[0]);
+
+// A parameter added to or reordered in the registry without updating the
+// factory bank would load values into the wrong parameters.
+constexpr bool layoutMatchesRegistry()
+{
+  if (kFactoryParams != params::kNumPresetParams)
+    return false;
+  for (size_t i = 0; i < kFactoryParams; ++i)
+    if (params::indexOf(kFactoryLayout[i]) != i)
+      return false;
+  return true;
+}
+static_assert(layoutMatchesRegistry(), "kFactoryLayout doesn't match params::getAll()");
+
+constexpr bool lessThan(const char* a, const char* b)
+{
+  while (*a != '\0' && *a == *b)
+  {
+    ++a;
+    ++b;
+  }
+  return (unsigned char) *a < (unsigned char) *b;
+}
+
+constexpr bool isSortedByName()
+{
+  for (size_t i = 1; i < kNumPresets; ++i)
+    if (!lessThan(kPresets[i - 1].name, kPresets[i].name))
+      return false;
+  return true;
+}
+static_assert(isSortedByName(), "keep kPresets sorted by name (and unique)");
+
+// Seeded FNV-1a; the seed is what the index search below varies.
+constexpr uint32_t hashName(std::string_view name, uint32_t seed)
+{
+  uint32_t hash = 2166136261u ^ seed;
+  for (const char c : name)
+  {
+    hash ^= (uint8_t) c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+constexpr size_t kSlots = [] {
+  size_t slots = 1;
+  while (slots < kNumPresets * 2)
+    slots *= 2;
+  return slots;
+}();
+constexpr uint8_t kEmptySlot = 0xff;
+static_assert(kNumPresets < kEmptySlot, "slot type too small for the bank");
+
+struct NameIndex
+{
+  uint32_t seed { 0 };
+  uint8_t slots[kSlots] {};
+  bool valid { false };
+};
+
+// Tries seeds until every name lands in its own slot (a perfect hash).
+// Runs in the compiler; with a half-empty table this takes a few tries.
+constexpr NameIndex buildIndex()
+{
+  for (uint32_t seed = 0; seed < 100000; ++seed)
+  {
+    NameIndex index;
+    index.seed = seed;
+    for (auto& slot : index.slots)
+      slot = kEmptySlot;
+
+    bool collision = false;
+    for (size_t i = 0; i < kNumPresets && !collision; ++i)
+    {
+      auto& slot = index.slots[hashName(kPresets[i].name, seed) & (kSlots - 1)];
+      collision = slot != kEmptySlot;
+      slot = (uint8_t) i;
+    }
+
+    if (!collision)
+    {
+      index.valid = true;
+      return index;
+    }
+  }
+  return {};
+}
+
+constexpr NameIndex kIndex = buildIndex();
+static_assert(kIndex.valid, "no perfect hash for the factory preset names");
+}
+
+size_t numFactoryPresets()
+{
+  return kNumPresets;
+}
+
+const FactoryPreset& getFactoryPreset(size_t index)
+{
+  return kPresets[index];
+}
+
+const FactoryPreset* findFactoryPreset(std::string_view name)
+{
+  const uint8_t slot = kIndex.slots[hashName(name, kIndex.seed) & (kSlots - 1)];
+  if (slot == kEmptySlot || name != kPresets[slot].name)
+    return nullptr;
+  return &kPresets[slot];
+}
+}
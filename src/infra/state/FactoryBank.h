@@ -0,0 +1,47 @@
+#pragma once
+
+#include "StateCodec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+  FactoryBank
+  -----------
+  The presets that ship with the plugin, compiled into the binary.
+
+  - Each preset is a name, tags and one plain value per preset parameter,
+    in kFactoryLayout order (which must be params::getAll() order; checked
+    at compile time). Loading one is a copy of those values into a
+    ParameterSnapshot: no SQLite, no decoding, no allocation of its own.
+  - The table and its name index are constexpr, so they live in the
+    binary's read-only data and cost nothing at startup. The index is a
+    perfect hash computed by the compiler: one hash + one string compare
+    per lookup, and adding a preset that would break it fails the build.
+  - Factory presets are never written to the database. The preset browser
+    lists them above the user's presets.
+
+  To add a factory preset: add a row to kPresets in FactoryBank.cpp. To add
+  a parameter: extend kFactoryLayout and give every preset a value.
+*/
+namespace state
+{
+// Parameter ids, in the order FactoryPreset::values stores them.
+inline constexpr const char* kFactoryLayout[] = { "gain", "trim", "truePeak" };
+inline constexpr size_t kFactoryParams = sizeof(kFactoryLayout) / sizeof(kFactoryLayout[0]);
+static_assert(kFactoryParams <= kMaxParams, "factory layout exceeds kMaxParams");
+
+struct FactoryPreset
+{
+  const char* name;
+  const char* tags;
+  float values[kFactoryParams]; // plain values, kFactoryLayout order
+};
+
+size_t numFactoryPresets();
+// Sorted by name, like they appear in the browser.
+const FactoryPreset& getFactoryPreset(size_t index);
+// nullptr if no factory preset has that exact name.
+const FactoryPreset* findFactoryPreset(std::string_view name);
+}
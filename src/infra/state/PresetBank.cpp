@@ -0,0 +1,143 @@
+/**
+  PresetBank.cpp
+  --------------
+  Bank file reader/writer. See PresetBank.h for the layout.
+*/
+#include "PresetBank.h"
+
+#include <limits>
+
+namespace state
+{
+namespace
+{
+constexpr uint32_t kMagic = 0x4b424750; // "PGBK" when read as bytes
+constexpr size_t kHeaderSize = 12;
+constexpr size_t kRecordHeaderSize = 16;
+constexpr size_t kCountOffset = 8;
+
+// Large enough that writing a 50k-preset bank is a few hundred syscalls.
+constexpr size_t kWriteBufferSize = 1 << 16;
+
+void writeLE(uint8_t* p, uint64_t v, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    p[i] = (uint8_t) (v >> (8 * i));
+}
+
+uint64_t readLE(const uint8_t* p, int bytes)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i)
+    v |= (uint64_t) p[i] << (8 * i);
+  return v;
+}
+}
+
+bool PresetBankReader::open(const void* data, size_t size)
+{
+  cursor = static_cast<const uint8_t*>(data);
+  end = cursor + size;
+  count = remaining = 0;
+  corrupt = false;
+
+  if (data == nullptr || size < kHeaderSize || readLE(cursor, 4) != kMagic
+      || readLE(cursor + 4, 2) > kBankVersion)
+  {
+    cursor = end = nullptr;
+    return false;
+  }
+
+  count = remaining = (uint32_t) readLE(cursor + kCountOffset, 4);
+  cursor += kHeaderSize;
+  return true;
+}
+
+bool PresetBankReader::next(BankRecord& record)
+{
+  if (remaining == 0 || corrupt)
+    return false;
+
+  if ((size_t) (end - cursor) < kRecordHeaderSize)
+  {
+    corrupt = true;
+    return false;
+  }
+
+  const size_t nameSize = (size_t) readLE(cursor, 2);
+  const size_t tagsSize = (size_t) readLE(cursor + 2, 2);
+  const size_t blobSize = (size_t) readLE(cursor + 4, 4);
+  const auto updatedAt = (int64_t) readLE(cursor + 8, 8);
+  const uint8_t* payload = cursor + kRecordHeaderSize;
+
+  if ((size_t) (end - payload) < nameSize + tagsSize + blobSize || nameSize == 0)
+  {
+    corrupt = true;
+    return false;
+  }
+
+  const auto* chars = reinterpret_cast<const char*>(payload);
+  record.name = std::string_view(chars, nameSize);
+  record.tags = std::string_view(chars + nameSize, tagsSize);
+  record.blob = std::string_view(chars + nameSize + tagsSize, blobSize);
+  record.updatedAt = updatedAt;
+
+  cursor = payload + nameSize + tagsSize + blobSize;
+  --remaining;
+  return true;
+}
+
+bool PresetBankWriter::open(const std::string& filePath)
+{
+  count = 0;
+  buffer.resize(kWriteBufferSize);
+  out.rdbuf()->pubsetbuf(buffer.data(), (std::streamsize) buffer.size());
+  out.open(filePath, std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+
+  uint8_t header[kHeaderSize];
+  writeLE(header, kMagic, 4);
+  writeLE(header + 4, kBankVersion, 2);
+  writeLE(header + 6, 0, 2);
+  writeLE(header + kCountOffset, 0, 4); // patched by finish()
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  return (bool) out;
+}
+
+bool PresetBankWriter::add(const BankRecord& record)
+{
+  if (record.name.empty()
+      || record.name.size() > std::numeric_limits<uint16_t>::max()
+      || record.tags.size() > std::numeric_limits<uint16_t>::max()
+      || record.blob.size() > std::numeric_limits<uint32_t>::max()
+      || count == std::numeric_limits<uint32_t>::max())
+    return false;
+
+  uint8_t header[kRecordHeaderSize];
+  writeLE(header, record.name.size(), 2);
+  writeLE(header + 2, record.tags.size(), 2);
+  writeLE(header + 4, record.blob.size(), 4);
+  writeLE(header + 8, (uint64_t) record.updatedAt, 8);
+
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(record.name.data(), (std::streamsize) record.name.size());
+  out.write(record.tags.data(), (std::streamsize) record.tags.size());
+  out.write(record.blob.data(), (std::streamsize) record.blob.size());
+  if (!out)
+    return false;
+
+  ++count;
+  return true;
+}
+
+bool PresetBankWriter::finish()
+{
+  uint8_t countBytes[4];
+  writeLE(countBytes, count, 4);
+  out.seekp((std::streamoff) kCountOffset);
+  out.write(reinterpret_cast<const char*>(countBytes), sizeof(countBytes));
+  out.close();
+  return !out.fail();
+}
+}
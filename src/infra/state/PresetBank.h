@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+  PresetBank
+  ----------
+  A single-file bundle of presets for moving libraries between machines
+  (export on one, import on the other).
+
+  Layout (little-endian):
+    offset 0   uint32  magic "PGBK"
+    offset 4   uint16  bank version
+    offset 6   uint16  flags (0)
+    offset 8   uint32  record count N
+    offset 12  N x record:
+                 uint16 name size, uint16 tags size, uint32 blob size,
+                 int64  updated_at (unix seconds),
+                 name bytes, tags bytes, blob bytes (StateCodec state)
+
+  Both sides stream: the writer appends records to a buffered file and
+  patches the count in finish(); the reader walks a memory block (meant to
+  be a memory-mapped file) and hands out views into it, so importing a
+  bank never copies it into memory first.
+*/
+namespace state
+{
+constexpr uint16_t kBankVersion = 1;
+
+struct BankRecord
+{
+  std::string_view name;
+  std::string_view tags;
+  std::string_view blob;
+  int64_t updatedAt { 0 };
+};
+
+class PresetBankReader
+{
+public:
+  // `data` must stay valid while records are read. Returns false if it is
+  // not a bank (or a newer version than this build understands).
+  bool open(const void* data, size_t size);
+
+  uint32_t declaredCount() const { return count; }
+
+  // Next record as views into the data; false at the end, or if the data
+  // is truncated/corrupt (failed() then tells the two apart).
+  bool next(BankRecord& record);
+  bool failed() const { return corrupt; }
+
+private:
+  const uint8_t* cursor { nullptr };
+  const uint8_t* end { nullptr };
+  uint32_t count { 0 };
+  uint32_t remaining { 0 };
+  bool corrupt { false };
+};
+
+class PresetBankWriter
+{
+public:
+  bool open(const std::string& filePath);
+
+  // False if the write failed or a field is too long for the format.
+  bool add(const BankRecord& record);
+
+  // Writes the final record count and closes the file.
+  bool finish();
+
+  uint32_t written() const { return count; }
+
+private:
+  std::ofstream out;
+  std::vector<char> buffer;
+  uint32_t count { 0 };
+};
+}
@@ -0,0 +1,311 @@
+/**
+  PresetLibrary.cpp
+  -----------------
+  Process-wide preset window + change propagation. See PresetLibrary.h.
+*/
+#include "PresetLibrary.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+
+namespace
+{
+// How often open editors check for changes made by other processes.
+constexpr int kPollIntervalMs = 1000;
+
+// Same order as PresetStore::findPresets(): newest first, then by name.
+bool isNewer(const PresetStore::PresetInfo& a, const PresetStore::PresetInfo& b)
+{
+  return a.updatedAt != b.updatedAt ? a.updatedAt > b.updatedAt : a.name > b.name;
+}
+}
+
+PresetLibrary::PresetLibrary()
+  : worker(getDefaultDatabaseFile())
+{
+}
+
+PresetLibrary::~PresetLibrary()
+{
+  stopTimer();
+}
+
+juce::File PresetLibrary::getDefaultDatabaseFile()
+{
+  return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+    .getChildFile("AbeAudio")
+    .getChildFile("ProGain")
+    .getChildFile("presets.db");
+}
+
+void PresetLibrary::addListener(Listener* listener)
+{
+  const bool first = listeners.isEmpty();
+  listeners.add(listener);
+
+  if (first)
+  {
+    // Loads the first page (and so catches up on anything that changed
+    // while nobody watched).
+    startNextJob();
+    startTimer(kPollIntervalMs);
+  }
+}
+
+void PresetLibrary::removeListener(Listener* listener)
+{
+  listeners.remove(listener);
+  if (!listeners.isEmpty())
+    return;
+
+  // Nobody is looking: drop the window. The next editor starts over with
+  // one page, and a job still in flight is ignored when it returns.
+  stopTimer();
+  presets.clear();
+  presets.shrink_to_fit();
+  next = {};
+  more = true;
+  loaded = false;
+  wantedRows = 0;
+  refreshWanted = false;
+  forceRefresh = false;
+  ++windowGeneration;
+}
+
+void PresetLibrary::ensureLoaded(int numRows)
+{
+  wantedRows = std::max(wantedRows, numRows);
+  startNextJob();
+}
+
+int PresetLibrary::indexOf(const std::string& name) const
+{
+  const auto found = std::find_if(presets.begin(), presets.end(),
+                                  [&name](const PresetStore::PresetInfo& info) { return info.name == name; });
+  return found == presets.end() ? -1 : (int) (found - presets.begin());
+}
+
+PresetWorker::Ticket PresetLibrary::savePreset(std::string name, std::string blob, std::string tags,
+                                               PresetWorker::SaveCallback done)
+{
+  return worker.submit([this, name = std::move(name), blob = std::move(blob), tags = std::move(tags),
+                        done = std::move(done)](PresetStore& db)
+  {
+    auto change = std::make_shared<Change>();
+    PresetStore::PresetInfo info;
+    const bool ok = db.savePreset(name, blob, tags) && db.findPreset(name, info);
+    if (ok)
+      change->upserted.push_back(std::move(info));
+
+    return std::function<void()>([this, change, done, ok]
+    {
+      if (ok)
+        apply(*change);
+      if (done)
+        done(ok);
+    });
+  });
+}
+
+PresetWorker::Ticket PresetLibrary::deletePreset(std::string name, PresetWorker::DeleteCallback done)
+{
+  return worker.submit([this, name = std::move(name), done = std::move(done)](PresetStore& db)
+  {
+    auto change = std::make_shared<Change>();
+    const bool ok = db.deletePreset(name);
+    if (ok)
+      change->removed.push_back(name);
+
+    return std::function<void()>([this, change, done, ok]
+    {
+      if (ok)
+        apply(*change);
+      if (done)
+        done(ok);
+    });
+  });
+}
+
+PresetWorker::Ticket PresetLibrary::importBank(juce::File bankFile, PresetWorker::BankCallback done)
+{
+  return worker.submit([this, bankFile = std::move(bankFile), done = std::move(done)](PresetStore& db)
+  {
+    const juce::MemoryMappedFile mapped(bankFile, juce::MemoryMappedFile::readOnly);
+    size_t imported = 0;
+    const bool ok = mapped.getData() != nullptr && db.importBank(mapped.getData(), mapped.getSize(), imported);
+
+    return std::function<void()>([this, done, ok, imported]
+    {
+      // A bank touches too many rows to patch one by one. Our own commit
+      // doesn't move data_version, so force the window query.
+      if (ok)
+        refreshWindow(true);
+      if (done)
+        done(ok, imported);
+    });
+  });
+}
+
+void PresetLibrary::timerCallback()
+{
+  refreshWindow(false);
+}
+
+void PresetLibrary::refreshWindow(bool force)
+{
+  refreshWanted = true;
+  forceRefresh = forceRefresh || force;
+  startNextJob();
+}
+
+void PresetLibrary::startNextJob()
+{
+  // One window/page job in flight at a time, however slow the worker is;
+  // the rest waits here and is picked up when it returns.
+  if (jobRunning || listeners.isEmpty())
+    return;
+
+  if (!loaded || refreshWanted)
+  {
+    const bool force = !loaded || forceRefresh;
+    refreshWanted = false;
+    forceRefresh = false;
+
+    jobRunning = true;
+    const uint32_t generation = windowGeneration;
+    const size_t numRows = presets.size();
+    worker.submit([this, generation, numRows, force](PresetStore& db)
+    {
+      auto window = std::make_shared<Window>();
+      const bool changed = queryWindow(db, numRows, force, *window);
+      return std::function<void()>([this, generation, window, changed]
+      {
+        if (finishJob(generation) && changed)
+          replaceWindow(std::move(*window));
+        startNextJob();
+      });
+    });
+  }
+  else if (more && (int) presets.size() < wantedRows)
+  {
+    fetchNextPage();
+  }
+}
+
+void PresetLibrary::fetchNextPage()
+{
+  jobRunning = true;
+  const uint32_t generation = windowGeneration;
+
+  PresetStore::Query query;
+  query.after = next;
+  query.limit = kPageSize;
+  worker.findPresets(query, [this, generation](const PresetStore::Page& page)
+  {
+    if (finishJob(generation))
+    {
+      Change change;
+      change.upserted = page.items;
+      presets.insert(presets.end(), page.items.begin(), page.items.end());
+      next = page.next;
+      more = page.hasMore;
+      listeners.call([&change](Listener& l) { l.presetLibraryChanged(change); });
+    }
+    startNextJob();
+  });
+}
+
+bool PresetLibrary::finishJob(uint32_t generation)
+{
+  jobRunning = false;
+  return generation == windowGeneration;
+}
+
+bool PresetLibrary::queryWindow(PresetStore& db, size_t numRows, bool force, Window& window)
+{
+  const int64_t version = db.dataVersion();
+  if (versionKnown && !force && version == knownVersion)
+    return false;
+  knownVersion = version;
+  versionKnown = true;
+
+  // As many rows as the window holds now, so nothing an editor shows
+  // disappears; the cost follows the window, not the library.
+  const size_t target = std::max(numRows, (size_t) kPageSize);
+  PresetStore::Query query;
+  for (;;)
+  {
+    query.limit = (int) std::min(target - window.presets.size(), (size_t) PresetStore::kMaxPageSize);
+    auto page = db.findPresets(query);
+    std::move(page.items.begin(), page.items.end(), std::back_inserter(window.presets));
+    window.next = page.next;
+    window.hasMore = page.hasMore;
+    if (!page.hasMore || page.items.empty() || window.presets.size() >= target)
+      return true;
+    query.after = page.next;
+  }
+}
+
+void PresetLibrary::replaceWindow(Window window)
+{
+  // Diff the old window against the new one (both bounded), so listeners
+  // only see what changed.
+  auto change = Change {};
+  change.reloaded = !loaded;
+  if (loaded)
+  {
+    std::unordered_map<std::string, const PresetStore::PresetInfo*> previous;
+    previous.reserve(presets.size());
+    for (const auto& info : presets)
+      previous.emplace(info.name, &info);
+
+    for (const auto& info : window.presets)
+    {
+      const auto found = previous.find(info.name);
+      if (found == previous.end() || found->second->updatedAt != info.updatedAt
+          || found->second->tags != info.tags)
+        change.upserted.push_back(info);
+      if (found != previous.end())
+        previous.erase(found);
+    }
+    for (const auto& entry : previous)
+      change.removed.push_back(entry.first);
+  }
+
+  presets = std::move(window.presets);
+  next = window.next;
+  more = window.hasMore;
+  loaded = true;
+  listeners.call([&change](Listener& l) { l.presetLibraryChanged(change); });
+}
+
+void PresetLibrary::apply(const Change& change)
+{
+  // Nothing loaded: the next window query will include the change.
+  if (!loaded)
+    return;
+
+  // Patch the sorted window in place: one erase/insert per changed preset.
+  auto erase = [this](const std::string& name)
+  {
+    const int index = indexOf(name);
+    if (index >= 0)
+      presets.erase(presets.begin() + index);
+  };
+
+  for (const auto& name : change.removed)
+    erase(name);
+
+  for (const auto& info : change.upserted)
+  {
+    erase(info.name);
+    // Rows past the end of the window arrive with a later page.
+    const auto position = std::lower_bound(presets.begin(), presets.end(), info, isNewer);
+    if (position != presets.end() || !more)
+      presets.insert(position, info);
+  }
+
+  listeners.call([&change](Listener& l) { l.presetLibraryChanged(change); });
+}
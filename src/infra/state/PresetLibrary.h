@@ -0,0 +1,133 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetStore.h"
+#include "PresetWorker.h"
+
+#include <string>
+#include <vector>
+
+/**
+  PresetLibrary
+  -------------
+  One preset index for the whole process, shared by every plugin instance.
+
+  A session with 200 ProGain instances used to mean 200 worker threads,
+  200 database connections and 200 editors each listing the library. Now:
+  - Processors hold a juce::SharedResourcePointer<PresetLibrary>: the first
+    one creates it, the last one to go destroys it. It owns the one
+    PresetWorker (thread + connection) everybody uses.
+  - It keeps a window of the library in memory: the newest presets (name,
+    tags, updated_at), a prefix of the newest-first order. The first editor
+    to open loads one page; editors ask for more with ensureLoaded() as
+    they scroll, one page at a time. Opening an editor costs one page
+    whatever the library size, and the window only holds what some editor
+    has scrolled to. It is dropped when the last editor closes.
+  - Editors draw straight from getPresets(); no copies per editor.
+  - Saves/deletes/imports made through the library patch the window and
+    tell every listener (every open editor) what changed.
+  - Changes from other processes (another DAW, a standalone app) are
+    noticed by polling SQLite's PRAGMA data_version once a second while an
+    editor is open. Only the loaded window is then queried again (one
+    index range read per 500 rows), diffed against the previous one, and
+    listeners get just the difference.
+
+  Message thread only, apart from what runs inside worker jobs.
+*/
+class PresetLibrary : private juce::Timer
+{
+public:
+  // Rows fetched per ensureLoaded() step.
+  static constexpr int kPageSize = 100;
+
+  PresetLibrary();
+  ~PresetLibrary() override;
+
+  static juce::File getDefaultDatabaseFile();
+
+  struct Change
+  {
+    bool reloaded { false }; // the window was (re)loaded from scratch
+    std::vector<std::string> removed;
+    std::vector<PresetStore::PresetInfo> upserted;
+  };
+
+  class Listener
+  {
+  public:
+    virtual ~Listener() = default;
+    // getPresets() already reflects the change when this is called.
+    virtual void presetLibraryChanged(const Change& change) = 0;
+  };
+
+  // The first listener triggers the first page and starts watching for
+  // outside changes; the last one to go stops watching and drops the
+  // window.
+  void addListener(Listener* listener);
+  void removeListener(Listener* listener);
+
+  // True once the first page has arrived.
+  bool isLoaded() const { return loaded; }
+  // The loaded window, newest first.
+  const std::vector<PresetStore::PresetInfo>& getPresets() const { return presets; }
+  // True if the library has presets beyond the window.
+  bool hasMore() const { return more; }
+  // Fetches the next page if fewer than numRows are loaded. Call it as the
+  // view scrolls; at most one fetch runs at a time.
+  void ensureLoaded(int numRows);
+  // Position in getPresets(), or -1 (also for presets beyond the window).
+  int indexOf(const std::string& name) const;
+
+  // Writes that keep the shared window (and every editor) up to date.
+  // Loads and searches go straight to getWorker().
+  PresetWorker::Ticket savePreset(std::string name, std::string blob, std::string tags = {},
+                                  PresetWorker::SaveCallback done = {});
+  PresetWorker::Ticket deletePreset(std::string name, PresetWorker::DeleteCallback done = {});
+  PresetWorker::Ticket importBank(juce::File bankFile, PresetWorker::BankCallback done = {});
+
+  PresetWorker& getWorker() { return worker; }
+
+private:
+  struct Window
+  {
+    std::vector<PresetStore::PresetInfo> presets;
+    PresetStore::Cursor next;
+    bool hasMore { false };
+  };
+
+  void timerCallback() override;
+  // Starts whatever is wanted (first page, refresh, next page) unless a
+  // job is already running.
+  void startNextJob();
+  void refreshWindow(bool force);
+  void fetchNextPage();
+  // Message thread, when a window/page job is back: false if the window
+  // was dropped meanwhile.
+  bool finishJob(uint32_t generation);
+  // Worker thread: the first `numRows` presets again (at least a page),
+  // unless the database hasn't changed since the last refresh.
+  bool queryWindow(PresetStore& db, size_t numRows, bool force, Window& window);
+  void replaceWindow(Window window);
+  void apply(const Change& change);
+
+  // Message thread.
+  std::vector<PresetStore::PresetInfo> presets; // newest first
+  PresetStore::Cursor next;                     // where the next page starts
+  bool more { true };
+  bool loaded { false };
+  int wantedRows { 0 };
+  bool jobRunning { false };
+  bool refreshWanted { false };
+  bool forceRefresh { false };
+  uint32_t windowGeneration { 0 }; // bumped when the window is dropped
+  juce::ListenerList<Listener> listeners;
+
+  // Worker thread: data_version as of the last window query.
+  int64_t knownVersion { 0 };
+  bool versionKnown { false };
+
+  // Last member: destroyed (thread stopped) before anything its jobs use.
+  PresetWorker worker;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
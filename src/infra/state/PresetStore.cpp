@@ -3,37 +3,339 @@
   ---------------
   SQLite-backed preset storage.
 
-  Table:
-  - name (primary key)
-  - data (binary blob of APVTS state)
-  - updated_at (unix timestamp)
+  Schema (version 1, tracked in PRAGMA user_version):
+  - presets: id (integer key), name (unique), blob_id, tags (free text),
+    updated_at (unix timestamp)
+  - blobs: id, hash, data. Content-addressed: every distinct state is
+    stored once however many presets use it. A blob is deleted by trigger
+    when its last preset goes.
+  - presets_by_updated: index on (updated_at, name) for newest-first
+    listing and keyset paging
+  - presets_fts: FTS5 index over name + tags, kept in sync by triggers
+    (external content: the text itself lives only in presets)
+
+  Older databases are upgraded once, on the first open(): version 0 (name
+  primary key, a data column per preset, no tags) is copied row by row
+  into the new tables, its states deduplicated on the way.
+
+  The connection stays open for the lifetime of the store and every query
+  is prepared once in open(). Each call only binds, steps and resets its
+  statement, so a save/load is a few microseconds of SQLite work instead of
+  re-parsing SQL and re-opening the file every time.
 */
 #include "PresetStore.h"
 
+#include "PresetBank.h"
+
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
 
 #if USE_SQLITE
   #include <sqlite3.h>
 #endif
 
-struct PresetStore::Impl
+namespace
 {
-#if USE_SQLITE
-  sqlite3* db { nullptr };
-#endif
+enum Statement
+{
+  kSave,
+  kLoad,
+  kDelete,
+  kList,
+  kBrowse,
+  kSearch,
+  kExport,
+  kFindBlob,
+  kInsertBlob,
+  kSavepoint,
+  kRelease,
+  kRollbackTo,
+  kInfo,
+  kDataVersion,
+  kNumStatements
 };
 
-namespace
-{
 #if USE_SQLITE
+constexpr int kSchemaVersion = 1;
+
+// An upsert rather than INSERT OR REPLACE: REPLACE deletes the old row
+// without running delete triggers, which would leave stale FTS entries.
+//
+// Paging queries take ?1/?2 = cursor (updated_at, name), ?3 = limit and
+// ?4 = search text, and walk the (updated_at, name) index backwards.
+const char* const kStatementSql[kNumStatements] = {
+  "INSERT INTO presets(name, blob_id, tags, updated_at) VALUES(?1, ?2, ?3, ?4) "
+  "ON CONFLICT(name) DO UPDATE SET blob_id = excluded.blob_id, tags = excluded.tags, "
+  "updated_at = excluded.updated_at;",
+  "SELECT b.data FROM presets AS p JOIN blobs AS b ON b.id = p.blob_id "
+  "WHERE p.name = ?;",
+  "DELETE FROM presets WHERE name = ?;",
+  "SELECT name FROM presets ORDER BY updated_at DESC, name DESC;",
+  "SELECT name, tags, updated_at FROM presets "
+  "WHERE (updated_at, name) < (?1, ?2) "
+  "ORDER BY updated_at DESC, name DESC LIMIT ?3;",
+  nullptr, // kSearch: depends on FTS5, see below
+  "SELECT p.name, p.tags, p.updated_at, b.data FROM presets AS p "
+  "JOIN blobs AS b ON b.id = p.blob_id ORDER BY p.updated_at, p.name;",
+  "SELECT id, data FROM blobs WHERE hash = ?;",
+  "INSERT INTO blobs(hash, data) VALUES(?1, ?2);",
+  // A savepoint nests inside importBank()'s transaction and is a plain
+  // transaction on its own.
+  "SAVEPOINT preset_write;",
+  "RELEASE preset_write;",
+  "ROLLBACK TO preset_write;",
+  "SELECT name, tags, updated_at FROM presets WHERE name = ?;",
+  "PRAGMA data_version;"
+};
+
+const char* const kFullTextSearchSql =
+  "SELECT p.name, p.tags, p.updated_at FROM presets_fts "
+  "JOIN presets AS p ON p.id = presets_fts.rowid "
+  "WHERE presets_fts MATCH ?4 AND (p.updated_at, p.name) < (?1, ?2) "
+  "ORDER BY p.updated_at DESC, p.name DESC LIMIT ?3;";
+
+const char* const kLikeSearchSql =
+  "SELECT name, tags, updated_at FROM presets "
+  "WHERE (updated_at, name) < (?1, ?2) "
+  "AND (name LIKE ?4 ESCAPE '\\' OR tags LIKE ?4 ESCAPE '\\') "
+  "ORDER BY updated_at DESC, name DESC LIMIT ?3;";
+
+// Built as presets_new next to a version 0 presets table, which is
+// copied over (migrateLegacyPresets()) and dropped before the rename.
+const char* const kCreateSchema =
+  "CREATE TABLE blobs("
+  "id INTEGER PRIMARY KEY,"
+  "hash INTEGER NOT NULL,"
+  "data BLOB NOT NULL"
+  ");"
+  "CREATE INDEX blobs_by_hash ON blobs(hash);"
+  "CREATE TABLE presets_new("
+  "id INTEGER PRIMARY KEY,"
+  "name TEXT NOT NULL UNIQUE,"
+  "blob_id INTEGER NOT NULL,"
+  "tags TEXT NOT NULL DEFAULT '',"
+  "updated_at INTEGER NOT NULL"
+  ");";
+
+const char* const kFinishSchema =
+  "ALTER TABLE presets_new RENAME TO presets;"
+  "CREATE INDEX presets_by_updated ON presets(updated_at, name);"
+  "CREATE INDEX presets_by_blob ON presets(blob_id);"
+  "CREATE TRIGGER blobs_release_delete AFTER DELETE ON presets BEGIN "
+  "DELETE FROM blobs WHERE id = old.blob_id "
+  "AND NOT EXISTS (SELECT 1 FROM presets WHERE blob_id = old.blob_id); "
+  "END;"
+  "CREATE TRIGGER blobs_release_update AFTER UPDATE OF blob_id ON presets "
+  "WHEN old.blob_id <> new.blob_id BEGIN "
+  "DELETE FROM blobs WHERE id = old.blob_id "
+  "AND NOT EXISTS (SELECT 1 FROM presets WHERE blob_id = old.blob_id); "
+  "END;";
+
+// prefix='2 3' keeps short prefix queries ("wa*", "war*") on the index.
+const char* const kCreateFullTextTable =
+  "CREATE VIRTUAL TABLE presets_fts USING fts5("
+  "name, tags, content='presets', content_rowid='id',"
+  "tokenize='unicode61 remove_diacritics 2', prefix='2 3');";
+
+const char* const kCreateFullTextTriggers =
+  "CREATE TRIGGER presets_fts_insert AFTER INSERT ON presets BEGIN "
+  "INSERT INTO presets_fts(rowid, name, tags) VALUES(new.id, new.name, new.tags); "
+  "END;"
+  "CREATE TRIGGER presets_fts_delete AFTER DELETE ON presets BEGIN "
+  "INSERT INTO presets_fts(presets_fts, rowid, name, tags) "
+  "VALUES('delete', old.id, old.name, old.tags); "
+  "END;"
+  "CREATE TRIGGER presets_fts_update AFTER UPDATE OF name, tags ON presets BEGIN "
+  "INSERT INTO presets_fts(presets_fts, rowid, name, tags) "
+  "VALUES('delete', old.id, old.name, old.tags); "
+  "INSERT INTO presets_fts(rowid, name, tags) VALUES(new.id, new.name, new.tags); "
+  "END;";
+
+const char* const kDropFullTextTriggers =
+  "DROP TRIGGER presets_fts_insert;"
+  "DROP TRIGGER presets_fts_delete;"
+  "DROP TRIGGER presets_fts_update;";
+
+const char* const kRebuildFullText =
+  "INSERT INTO presets_fts(presets_fts) VALUES('rebuild');";
+
+// Bank imports at least this big (and at least half the library's size)
+// rebuild the FTS index once at the end instead of updating it per row:
+// ~3x faster than the triggers for bulk loads.
+constexpr uint32_t kBulkRebuildMinPresets = 1000;
+
+// WAL lets readers (other plugin instances) proceed while one writes, and
+// NORMAL sync is durable across application crashes in WAL mode.
+const char* const kConnectionPragmas =
+  "PRAGMA journal_mode=WAL;"
+  "PRAGMA synchronous=NORMAL;"
+  "PRAGMA temp_store=MEMORY;"
+  "PRAGMA cache_size=-2048;";
+
+// How long a writer waits for another instance's lock before failing.
+constexpr int kBusyTimeoutMs = 2000;
+
 int64_t nowUnixSeconds()
 {
   using namespace std::chrono;
   return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
 }
+
+// Returns a cached statement to its initial state when the call is done,
+// whichever path it leaves by.
+struct ScopedReset
+{
+  explicit ScopedReset(sqlite3_stmt* s) : stmt(s) {}
+  ~ScopedReset()
+  {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+  }
+
+  sqlite3_stmt* stmt;
+};
+
+int queryInt(sqlite3* db, const char* sql)
+{
+  sqlite3_stmt* stmt = nullptr;
+  int value = 0;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+    value = sqlite3_column_int(stmt, 0);
+  sqlite3_finalize(stmt);
+  return value;
+}
+
+bool tableExists(sqlite3* db, const char* name)
+{
+  sqlite3_stmt* stmt = nullptr;
+  bool exists = false;
+  if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", -1,
+                         &stmt, nullptr) == SQLITE_OK)
+  {
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    exists = sqlite3_step(stmt) == SQLITE_ROW;
+  }
+  sqlite3_finalize(stmt);
+  return exists;
+}
+
+// Owns a statement prepared for one-off use (migration).
+struct TempStatement
+{
+  TempStatement(sqlite3* db, const char* sql) { sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr); }
+  ~TempStatement() { sqlite3_finalize(stmt); }
+
+  sqlite3_stmt* stmt { nullptr };
+};
+
+void bindBytes(sqlite3_stmt* stmt, int index, const void* data, size_t size)
+{
+  if (size == 0)
+    sqlite3_bind_zeroblob(stmt, index, 0);
+  else
+    sqlite3_bind_blob(stmt, index, data, (int) size, SQLITE_STATIC);
+}
+
+// 64-bit FNV-1a. It only narrows the lookup: the bytes are still compared
+// before two blobs count as the same, so a collision can never make one
+// preset load another's state.
+uint64_t contentHash(const void* data, size_t size)
+{
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Finds `data` among the stored blobs (same hash, then same bytes) or
+// stores it. Returns the blob id, or 0 on error.
+int64_t internBlob(sqlite3_stmt* find, sqlite3_stmt* insert, const void* data, size_t size)
+{
+  const auto hash = (int64_t) contentHash(data, size);
+
+  {
+    ScopedReset reset(find);
+    sqlite3_bind_int64(find, 1, hash);
+    while (sqlite3_step(find) == SQLITE_ROW)
+    {
+      const void* stored = sqlite3_column_blob(find, 1);
+      if ((size_t) sqlite3_column_bytes(find, 1) == size
+          && (size == 0 || std::memcmp(stored, data, size) == 0))
+        return sqlite3_column_int64(find, 0);
+    }
+  }
+
+  ScopedReset reset(insert);
+  sqlite3_bind_int64(insert, 1, hash);
+  bindBytes(insert, 2, data, size);
+
+  if (sqlite3_step(insert) != SQLITE_DONE)
+    return 0;
+  return sqlite3_last_insert_rowid(sqlite3_db_handle(insert));
+}
+
+// "warm ba" -> "warm"* "ba"* : every word must appear, as a word prefix,
+// in the name or the tags. Words are quoted so FTS5 operators and
+// punctuation in user input are taken literally.
+std::string toFullTextQuery(const std::string& text)
+{
+  std::string query;
+  size_t i = 0;
+  while (i < text.size())
+  {
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i])))
+      ++i;
+
+    std::string word;
+    while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])))
+    {
+      if (text[i] == '"')
+        word += '"';
+      word += text[i++];
+    }
+
+    if (!word.empty())
+    {
+      if (!query.empty())
+        query += ' ';
+      query += '"' + word + "\"*";
+    }
+  }
+  return query;
+}
+
+// Substring pattern for the LIKE fallback.
+std::string toLikePattern(const std::string& text)
+{
+  std::string pattern = "%";
+  for (const char c : text)
+  {
+    if (c == '%' || c == '_' || c == '\\')
+      pattern += '\\';
+    pattern += c;
+  }
+  return pattern + '%';
+}
 #endif
 }
 
+struct PresetStore::Impl
+{
+#if USE_SQLITE
+  sqlite3* db { nullptr };
+  sqlite3_stmt* statements[kNumStatements] {};
+  bool fullText { false };
+#endif
+};
+
 PresetStore::PresetStore() : impl(new Impl())
 {
 }
@@ -60,21 +362,39 @@ bool PresetStore::open(const std::string& filePath)
     return false;
   }
 
-  const char* sql =
-    "CREATE TABLE IF NOT EXISTS presets("
-    "name TEXT PRIMARY KEY,"
-    "data BLOB NOT NULL,"
-    "updated_at INTEGER NOT NULL"
-    ");";
+  sqlite3_busy_timeout(impl->db, kBusyTimeoutMs);
 
   char* errMsg = nullptr;
-  if (sqlite3_exec(impl->db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK)
+  if (sqlite3_exec(impl->db, kConnectionPragmas, nullptr, nullptr, &errMsg) != SQLITE_OK)
   {
-    lastErr = errMsg ? errMsg : "Failed to create presets table";
+    lastErr = errMsg ? errMsg : "Failed to configure preset database";
     sqlite3_free(errMsg);
+    close();
+    return false;
+  }
+
+  if (!migrateSchema())
+  {
+    close();
     return false;
   }
 
+  // Search still works without FTS5, just by scanning.
+  impl->fullText = ensureFullTextIndex();
+
+  for (int i = 0; i < kNumStatements; ++i)
+  {
+    const char* sql = i == kSearch ? (impl->fullText ? kFullTextSearchSql : kLikeSearchSql)
+                                   : kStatementSql[i];
+    if (sqlite3_prepare_v3(impl->db, sql, -1, SQLITE_PREPARE_PERSISTENT,
+                           &impl->statements[i], nullptr) != SQLITE_OK)
+    {
+      lastErr = sqlite3_errmsg(impl->db);
+      close();
+      return false;
+    }
+  }
+
   return true;
 #else
   (void) filePath;
@@ -82,55 +402,201 @@ bool PresetStore::open(const std::string& filePath)
 #endif
 }
 
+bool PresetStore::migrateSchema()
+{
+#if USE_SQLITE
+  // Cheap check first: every open after the first one stops here.
+  if (queryInt(impl->db, "PRAGMA user_version;") >= kSchemaVersion)
+    return true;
+
+  // IMMEDIATE takes the write lock up front, so two instances opening a
+  // fresh database at once migrate it exactly once (the second one waits
+  // on the busy timeout, then sees the new version).
+  char* errMsg = nullptr;
+  auto run = [&](const char* sql) {
+    return sqlite3_exec(impl->db, sql, nullptr, nullptr, &errMsg) == SQLITE_OK;
+  };
+
+  if (!run("BEGIN IMMEDIATE;"))
+  {
+    lastErr = errMsg ? errMsg : "Failed to lock preset database";
+    sqlite3_free(errMsg);
+    return false;
+  }
+
+  // Re-check under the lock: another instance may have just migrated.
+  if (queryInt(impl->db, "PRAGMA user_version;") >= kSchemaVersion)
+    return run("COMMIT;");
+
+  const bool hasLegacyTable = tableExists(impl->db, "presets");
+  const bool ok = run(kCreateSchema)
+                  && (!hasLegacyTable || (migrateLegacyPresets() && run("DROP TABLE presets;")))
+                  && run(kFinishSchema)
+                  && run(("PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";").c_str());
+
+  if (ok && run("COMMIT;"))
+    return true;
+
+  lastErr = errMsg ? errMsg : "Failed to migrate preset database";
+  sqlite3_free(errMsg);
+  sqlite3_exec(impl->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+  return false;
+#else
+  return false;
+#endif
+}
+
+bool PresetStore::migrateLegacyPresets()
+{
+#if USE_SQLITE
+  // Reads the old table while writing the new ones, so one pass is enough.
+  TempStatement select(impl->db, "SELECT name, data, updated_at FROM presets;");
+  TempStatement insert(impl->db, "INSERT INTO presets_new(name, blob_id, updated_at) VALUES(?1, ?2, ?3);");
+  TempStatement findBlob(impl->db, kStatementSql[kFindBlob]);
+  TempStatement insertBlob(impl->db, kStatementSql[kInsertBlob]);
+  if (!select.stmt || !insert.stmt || !findBlob.stmt || !insertBlob.stmt)
+    return false;
+
+  int rc;
+  while ((rc = sqlite3_step(select.stmt)) == SQLITE_ROW)
+  {
+    const int64_t blobId = internBlob(findBlob.stmt, insertBlob.stmt, sqlite3_column_blob(select.stmt, 1),
+                                      (size_t) sqlite3_column_bytes(select.stmt, 1));
+    if (blobId == 0)
+      return false;
+
+    ScopedReset reset(insert.stmt);
+    sqlite3_bind_value(insert.stmt, 1, sqlite3_column_value(select.stmt, 0));
+    sqlite3_bind_int64(insert.stmt, 2, blobId);
+    sqlite3_bind_int64(insert.stmt, 3, sqlite3_column_int64(select.stmt, 2));
+    if (sqlite3_step(insert.stmt) != SQLITE_DONE)
+      return false;
+  }
+  return rc == SQLITE_DONE;
+#else
+  return false;
+#endif
+}
+
+bool PresetStore::ensureFullTextIndex()
+{
+#if USE_SQLITE
+  if (tableExists(impl->db, "presets_fts"))
+    return true;
+
+  if (sqlite3_exec(impl->db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    return false;
+
+  // Re-check under the lock: another instance may have just created it.
+  auto run = [this](const char* sql) {
+    return sqlite3_exec(impl->db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+  };
+  const bool ok = tableExists(impl->db, "presets_fts")
+                  || (run(kCreateFullTextTable) && run(kCreateFullTextTriggers) && run(kRebuildFullText));
+
+  if (ok && sqlite3_exec(impl->db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK)
+    return true;
+
+  // Typically "no such module: fts5".
+  sqlite3_exec(impl->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+  return false;
+#else
+  return false;
+#endif
+}
+
 void PresetStore::close()
 {
 #if USE_SQLITE
   if (impl && impl->db)
   {
+    for (auto*& stmt : impl->statements)
+    {
+      sqlite3_finalize(stmt);
+      stmt = nullptr;
+    }
+
     sqlite3_close(impl->db);
     impl->db = nullptr;
+    impl->fullText = false;
   }
 #endif
 }
 
-bool PresetStore::savePreset(const std::string& name, const std::string& blob)
+bool PresetStore::isOpen() const
+{
+#if USE_SQLITE
+  return impl->db != nullptr;
+#else
+  return false;
+#endif
+}
+
+bool PresetStore::savePreset(const std::string& name, const std::string& blob,
+                             const std::string& tags)
 {
 #if USE_SQLITE
   if (!impl->db)
     return false;
 
   lastErr.clear();
+  return writePreset(name, blob, tags, nowUnixSeconds());
+#else
+  (void) name;
+  (void) blob;
+  (void) tags;
+  return false;
+#endif
+}
 
-  const char* sql =
-    "INSERT OR REPLACE INTO presets(name, data, updated_at) VALUES(?, ?, ?);";
+bool PresetStore::writePreset(std::string_view name, std::string_view blob, std::string_view tags,
+                              int64_t updatedAt)
+{
+#if USE_SQLITE
+  // Blob + preset row land together or not at all.
+  auto runCached = [this](Statement which) {
+    ScopedReset reset(impl->statements[which]);
+    return sqlite3_step(impl->statements[which]) == SQLITE_DONE;
+  };
 
-  sqlite3_stmt* stmt = nullptr;
-  if (sqlite3_prepare_v2(impl->db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+  if (!runCached(kSavepoint))
   {
     lastErr = sqlite3_errmsg(impl->db);
     return false;
   }
 
-  sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
-  if (blob.empty())
-    sqlite3_bind_blob(stmt, 2, nullptr, 0, SQLITE_TRANSIENT);
-  else
-    sqlite3_bind_blob(stmt, 2, blob.data(), (int) blob.size(), SQLITE_TRANSIENT);
-  sqlite3_bind_int64(stmt, 3, nowUnixSeconds());
-
-  const int rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  // Saving a state that is already stored (again, or under another name)
+  // only finds it; nothing new is written but the preset row.
+  const int64_t blobId = internBlob(impl->statements[kFindBlob], impl->statements[kInsertBlob],
+                                    blob.data(), blob.size());
 
-  if (rc != SQLITE_DONE)
+  bool ok = blobId != 0;
+  if (ok)
   {
-    lastErr = sqlite3_errmsg(impl->db);
-    return false;
+    auto* stmt = impl->statements[kSave];
+    ScopedReset reset(stmt);
+
+    // SQLITE_STATIC: the strings outlive the step, and the reset above
+    // drops the bindings before we return.
+    sqlite3_bind_text(stmt, 1, name.data(), (int) name.size(), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, blobId);
+    sqlite3_bind_text(stmt, 3, tags.data(), (int) tags.size(), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, updatedAt);
+    ok = sqlite3_step(stmt) == SQLITE_DONE;
   }
 
-  return true;
+  if (ok && runCached(kRelease))
+    return true;
+
+  lastErr = sqlite3_errmsg(impl->db);
+  runCached(kRollbackTo);
+  runCached(kRelease);
+  return false;
 #else
   (void) name;
   (void) blob;
+  (void) tags;
+  (void) updatedAt;
   return false;
 #endif
 }
@@ -143,27 +609,21 @@ bool PresetStore::loadPreset(const std::string& name, std::string& outBlob)
 
   lastErr.clear();
 
-  const char* sql = "SELECT data FROM presets WHERE name = ?;";
-  sqlite3_stmt* stmt = nullptr;
-  if (sqlite3_prepare_v2(impl->db, sql, -1, &stmt, nullptr) != SQLITE_OK)
-  {
-    lastErr = sqlite3_errmsg(impl->db);
-    return false;
-  }
+  auto* stmt = impl->statements[kLoad];
+  ScopedReset reset(stmt);
 
-  sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 1, name.data(), (int) name.size(), SQLITE_STATIC);
 
   const int rc = sqlite3_step(stmt);
   if (rc == SQLITE_ROW)
   {
-    const void* blob = sqlite3_column_blob(stmt, 0);
-    const int size = sqlite3_column_bytes(stmt, 0);
-    outBlob.assign(static_cast<const char*>(blob), static_cast<size_t>(size));
-    sqlite3_finalize(stmt);
+    const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt, 0));
+    outBlob.assign(data ? data : "", (size_t) sqlite3_column_bytes(stmt, 0));
     return true;
   }
 
-  sqlite3_finalize(stmt);
+  if (rc != SQLITE_DONE)
+    lastErr = sqlite3_errmsg(impl->db);
   return false;
 #else
   (void) name;
@@ -180,20 +640,12 @@ bool PresetStore::deletePreset(const std::string& name)
 
   lastErr.clear();
 
-  const char* sql = "DELETE FROM presets WHERE name = ?;";
-  sqlite3_stmt* stmt = nullptr;
-  if (sqlite3_prepare_v2(impl->db, sql, -1, &stmt, nullptr) != SQLITE_OK)
-  {
-    lastErr = sqlite3_errmsg(impl->db);
-    return false;
-  }
+  auto* stmt = impl->statements[kDelete];
+  ScopedReset reset(stmt);
 
-  sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 1, name.data(), (int) name.size(), SQLITE_STATIC);
 
-  const int rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
-
-  if (rc != SQLITE_DONE)
+  if (sqlite3_step(stmt) != SQLITE_DONE)
   {
     lastErr = sqlite3_errmsg(impl->db);
     return false;
@@ -214,20 +666,275 @@ std::vector<std::string> PresetStore::listPresets() const
   if (!impl->db)
     return names;
 
-  const char* sql = "SELECT name FROM presets ORDER BY updated_at DESC;";
-  sqlite3_stmt* stmt = nullptr;
-  if (sqlite3_prepare_v2(impl->db, sql, -1, &stmt, nullptr) != SQLITE_OK)
-    return names;
+  auto* stmt = impl->statements[kList];
+  ScopedReset reset(stmt);
 
   while (sqlite3_step(stmt) == SQLITE_ROW)
   {
     const unsigned char* text = sqlite3_column_text(stmt, 0);
     if (text)
-      names.emplace_back(reinterpret_cast<const char*>(text));
+      names.emplace_back(reinterpret_cast<const char*>(text),
+                         static_cast<size_t>(sqlite3_column_bytes(stmt, 0)));
   }
-
-  sqlite3_finalize(stmt);
 #endif
 
   return names;
 }
+
+PresetStore::Page PresetStore::findPresets(const Query& query) const
+{
+  Page page;
+
+#if USE_SQLITE
+  if (!impl->db)
+    return page;
+
+  const int limit = std::clamp(query.limit, 1, kMaxPageSize);
+
+  std::string match;
+  const bool searching = query.text.find_first_not_of(" \t\r\n") != std::string::npos;
+  if (searching)
+    match = impl->fullText ? toFullTextQuery(query.text) : toLikePattern(query.text);
+
+  auto* stmt = impl->statements[searching ? kSearch : kBrowse];
+  ScopedReset reset(stmt);
+
+  sqlite3_bind_int64(stmt, 1, query.after.updatedAt);
+  sqlite3_bind_text(stmt, 2, query.after.name.data(), (int) query.after.name.size(), SQLITE_STATIC);
+  // One extra row tells us whether another page follows.
+  sqlite3_bind_int(stmt, 3, limit + 1);
+  if (searching)
+    sqlite3_bind_text(stmt, 4, match.data(), (int) match.size(), SQLITE_STATIC);
+
+  page.items.reserve((size_t) limit);
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    if ((int) page.items.size() == limit)
+    {
+      page.hasMore = true;
+      break;
+    }
+
+    PresetInfo info;
+    auto text = [stmt](int column) {
+      const auto* chars = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+      return chars ? std::string(chars, (size_t) sqlite3_column_bytes(stmt, column)) : std::string();
+    };
+    info.name = text(0);
+    info.tags = text(1);
+    info.updatedAt = sqlite3_column_int64(stmt, 2);
+    page.items.push_back(std::move(info));
+  }
+
+  if (!page.items.empty())
+    page.next = { page.items.back().updatedAt, page.items.back().name };
+#else
+  (void) query;
+#endif
+
+  return page;
+}
+
+bool PresetStore::importBank(const void* bankData, size_t bankSize, size_t& imported)
+{
+  imported = 0;
+
+#if USE_SQLITE
+  if (!impl->db)
+    return false;
+
+  lastErr.clear();
+
+  state::PresetBankReader reader;
+  if (!reader.open(bankData, bankSize))
+  {
+    lastErr = "Not a preset bank";
+    return false;
+  }
+
+  // One transaction for the whole bank: a single WAL commit (and sync)
+  // instead of one per preset, and other instances never see half a bank.
+  if (sqlite3_exec(impl->db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+  {
+    lastErr = sqlite3_errmsg(impl->db);
+    return false;
+  }
+
+  auto run = [this](const char* sql) {
+    return sqlite3_exec(impl->db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+  };
+
+  // Large banks: drop the per-row FTS triggers for the duration and
+  // rebuild the index once. All inside the transaction, so no other
+  // connection ever sees the index out of sync.
+  const bool rebuildFullText = impl->fullText && reader.declaredCount() >= kBulkRebuildMinPresets
+                               && (int64_t) reader.declaredCount() * 2
+                                    >= (int64_t) queryInt(impl->db, "SELECT count(*) FROM presets;");
+
+  bool ok = !rebuildFullText || run(kDropFullTextTriggers);
+  size_t count = 0;
+
+  // The views point into the caller's (mapped) bank, valid for each write.
+  state::BankRecord record;
+  while (ok && reader.next(record))
+  {
+    ok = writePreset(record.name, record.blob, record.tags, record.updatedAt);
+    if (ok)
+      ++count;
+  }
+
+  if (ok && reader.failed())
+  {
+    ok = false;
+    lastErr = "Preset bank is truncated or corrupt";
+  }
+
+  if (ok && rebuildFullText)
+    ok = run(kCreateFullTextTriggers) && run(kRebuildFullText);
+
+  if (ok && sqlite3_exec(impl->db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK)
+  {
+    imported = count;
+    return true;
+  }
+
+  if (lastErr.empty())
+    lastErr = sqlite3_errmsg(impl->db);
+  sqlite3_exec(impl->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+  return false;
+#else
+  (void) bankData;
+  (void) bankSize;
+  return false;
+#endif
+}
+
+bool PresetStore::exportBank(const std::string& bankPath, size_t& exported) const
+{
+  exported = 0;
+
+#if USE_SQLITE
+  if (!impl->db)
+    return false;
+
+  lastErr.clear();
+
+  {
+    state::PresetBankWriter writer;
+    if (!writer.open(bankPath))
+    {
+      lastErr = "Cannot create bank file";
+      return false;
+    }
+
+    // A single statement reads from one consistent snapshot, even while
+    // another instance writes.
+    auto* stmt = impl->statements[kExport];
+    ScopedReset reset(stmt);
+
+    auto view = [stmt](int column) {
+      const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt, column));
+      return std::string_view(data ? data : "", (size_t) sqlite3_column_bytes(stmt, column));
+    };
+
+    int rc = SQLITE_DONE;
+    while (lastErr.empty() && (rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+      state::BankRecord record;
+      record.name = view(0);
+      record.tags = view(1);
+      record.updatedAt = sqlite3_column_int64(stmt, 2);
+      record.blob = view(3);
+      if (!writer.add(record))
+        lastErr = "Failed to write bank file";
+    }
+
+    if (lastErr.empty() && rc != SQLITE_DONE)
+      lastErr = sqlite3_errmsg(impl->db);
+    if (lastErr.empty() && !writer.finish())
+      lastErr = "Failed to write bank file";
+    if (lastErr.empty())
+      exported = writer.written();
+  }
+
+  // The writer is closed by now; don't leave half a bank behind.
+  if (!lastErr.empty())
+  {
+    std::remove(bankPath.c_str());
+    return false;
+  }
+  return true;
+#else
+  (void) bankPath;
+  return false;
+#endif
+}
+
+bool PresetStore::findPreset(const std::string& name, PresetInfo& info) const
+{
+#if USE_SQLITE
+  if (!impl->db)
+    return false;
+
+  auto* stmt = impl->statements[kInfo];
+  ScopedReset reset(stmt);
+
+  sqlite3_bind_text(stmt, 1, name.data(), (int) name.size(), SQLITE_STATIC);
+  if (sqlite3_step(stmt) != SQLITE_ROW)
+    return false;
+
+  const auto* tags = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+  info.name = name;
+  info.tags = tags ? std::string(tags, (size_t) sqlite3_column_bytes(stmt, 1)) : std::string();
+  info.updatedAt = sqlite3_column_int64(stmt, 2);
+  return true;
+#else
+  (void) name;
+  (void) info;
+  return false;
+#endif
+}
+
+int64_t PresetStore::dataVersion() const
+{
+#if USE_SQLITE
+  if (!impl->db)
+    return 0;
+
+  auto* stmt = impl->statements[kDataVersion];
+  ScopedReset reset(stmt);
+  return sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+#else
+  return 0;
+#endif
+}
+
+PresetStore::StorageStats PresetStore::storageStats() const
+{
+  StorageStats stats;
+
+#if USE_SQLITE
+  if (!impl->db)
+    return stats;
+
+  TempStatement query(impl->db,
+                      "SELECT (SELECT count(*) FROM presets), count(*), total(length(data)) FROM blobs;");
+  if (query.stmt && sqlite3_step(query.stmt) == SQLITE_ROW)
+  {
+    stats.presets = (size_t) sqlite3_column_int64(query.stmt, 0);
+    stats.blobs = (size_t) sqlite3_column_int64(query.stmt, 1);
+    stats.storedBytes = (uint64_t) sqlite3_column_double(query.stmt, 2);
+  }
+#endif
+
+  return stats;
+}
+
+bool PresetStore::hasFullTextSearch() const
+{
+#if USE_SQLITE
+  return impl->fullText;
+#else
+  return false;
+#endif
+}
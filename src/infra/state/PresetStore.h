@@ -1,38 +1,139 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
   PresetStore (SQLite)
   --------------------
-  A minimal wrapper that will store and retrieve presets from SQLite.
-  This file is intentionally simple for now; it will be fleshed out
-  once you decide the exact preset format and fields to store.
+  A minimal wrapper that stores and retrieves presets from SQLite.
 
-  Usage (future):
-  - open(dbPath)
+  Usage:
+  - open(dbPath) once; keep the store around (the processor owns one)
   - savePreset(name, blob)
   - loadPreset(name, outBlob)
+
+  open() switches the database to WAL mode and prepares every query up
+  front; the calls below reuse those statements, so they cost microseconds.
+  Not thread-safe: use one store from one thread (the message thread).
+
+  Large libraries (tens of thousands of presets):
+  - findPresets() returns one bounded page at a time, newest first, and a
+    cursor for the next page. Paging is "keyset" based: the next page
+    starts after the last (updated_at, name) seen, so page 500 costs the
+    same as page 1 (no OFFSET scan) and saves in between never shift or
+    repeat rows.
+  - With a search text, names and tags are matched through an FTS5
+    full-text index ("war ba" finds "Warm Bass": every word is a prefix).
+    Unlike browsing, a search page costs O(matches), not O(page): FTS5
+    hands back every match and SQLite sorts them by (updated_at, name)
+    before the cursor and limit apply. A broad term over 100k presets
+    ("warm", 12.5k matches) is ~15 ms per page, so walking all 125 pages
+    takes ~2 s; narrow the search rather than paging far into it.
+  - listPresets() still returns every name; avoid it for big libraries.
+
+  State blobs are content-addressed: presets with byte-identical state
+  share one stored copy, so saving a duplicate only writes the preset row.
+
+  Moving libraries: exportBank() streams every preset into a bank file
+  (infra/state/PresetBank.h); importBank() reads one from memory (map the
+  file) and writes all of it in a single transaction, so thousands of
+  presets cost one commit instead of one each.
 */
 class PresetStore
 {
 public:
+  // Upper bound for Query::limit, so one call never builds a huge page.
+  static constexpr int kMaxPageSize = 500;
+
+  struct PresetInfo
+  {
+    std::string name;
+    std::string tags;
+    int64_t updatedAt { 0 }; // unix seconds
+  };
+
+  // Position in the newest-first order. The default is "before the first
+  // row"; pass a page's `next` to continue after it.
+  struct Cursor
+  {
+    int64_t updatedAt { std::numeric_limits<int64_t>::max() };
+    std::string name;
+  };
+
+  struct Query
+  {
+    std::string text; // empty = browse everything
+    Cursor after;
+    int limit { 100 };
+  };
+
+  struct StorageStats
+  {
+    size_t presets { 0 };
+    size_t blobs { 0 };        // distinct states actually stored
+    uint64_t storedBytes { 0 }; // their total size
+  };
+
+  struct Page
+  {
+    std::vector<PresetInfo> items;
+    Cursor next;
+    bool hasMore { false };
+  };
+
   PresetStore();
   ~PresetStore();
 
   bool open(const std::string& filePath);
   void close();
+  bool isOpen() const;
 
-  bool savePreset(const std::string& name, const std::string& blob);
+  // tags: free text, e.g. "bass warm analog"; searched along with the name.
+  bool savePreset(const std::string& name, const std::string& blob,
+                  const std::string& tags = {});
   bool loadPreset(const std::string& name, std::string& outBlob);
   bool deletePreset(const std::string& name);
   std::vector<std::string> listPresets() const;
+  Page findPresets(const Query& query) const;
+  bool findPreset(const std::string& name, PresetInfo& info) const;
+
+  // Changes whenever another connection (another process, or another store
+  // in this one) commits to the database; our own writes leave it alone.
+  // Cheap enough to poll.
+  int64_t dataVersion() const;
+
+  // All or nothing: on any error nothing is imported. Presets that already
+  // exist are replaced; updated_at comes from the bank. `imported` is the
+  // number of presets written.
+  bool importBank(const void* bankData, size_t bankSize, size_t& imported);
+  // Oldest first, so re-importing keeps the order. On failure no bank
+  // file is left behind.
+  bool exportBank(const std::string& bankPath, size_t& exported) const;
+
+  // How much deduplication saved. Counts rows: slow-ish on
+  // big libraries, meant for diagnostics and benchmarks.
+  StorageStats storageStats() const;
+
+  // False when this SQLite build has no FTS5; search then falls back to a
+  // (slow) LIKE scan.
+  bool hasFullTextSearch() const;
 
   const std::string& lastError() const { return lastErr; }
 
 private:
+  bool migrateSchema();
+  bool migrateLegacyPresets();
+  bool writePreset(std::string_view name, std::string_view blob, std::string_view tags, int64_t updatedAt);
+  bool ensureFullTextIndex();
+
   struct Impl;
   Impl* impl { nullptr };
-  std::string lastErr;
+  mutable std::string lastErr; // also set by const calls (exportBank)
+
+  PresetStore(const PresetStore&) = delete;
+  PresetStore& operator=(const PresetStore&) = delete;
 };
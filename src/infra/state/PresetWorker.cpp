@@ -0,0 +1,191 @@
+/**
+  PresetWorker.cpp
+  ----------------
+  Request queue + worker thread around PresetStore. See PresetWorker.h.
+*/
+#include "PresetWorker.h"
+
+PresetWorker::PresetWorker(juce::File file)
+  : juce::Thread("ProGain preset I/O"), databaseFile(std::move(file))
+{
+  startThread();
+}
+
+PresetWorker::~PresetWorker()
+{
+  cancelAll();
+  signalThreadShouldExit();
+  notify();
+  stopThread(5000);
+  store.close();
+}
+
+PresetWorker::Ticket PresetWorker::savePreset(std::string name, std::string blob, SaveCallback done,
+                                              std::string tags)
+{
+  return submit([name = std::move(name), blob = std::move(blob), done = std::move(done),
+                 tags = std::move(tags)](PresetStore& db)
+  {
+    const bool ok = db.savePreset(name, blob, tags);
+    return std::function<void()>([done, ok] { if (done) done(ok); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::loadPreset(std::string name, LoadCallback done)
+{
+  return submit([name = std::move(name), done = std::move(done)](PresetStore& db)
+  {
+    auto blob = std::make_shared<std::string>();
+    const bool found = db.loadPreset(name, *blob);
+    return std::function<void()>([done, found, blob] { if (done) done(found, *blob); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::deletePreset(std::string name, DeleteCallback done)
+{
+  return submit([name = std::move(name), done = std::move(done)](PresetStore& db)
+  {
+    const bool ok = db.deletePreset(name);
+    return std::function<void()>([done, ok] { if (done) done(ok); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::listPresets(ListCallback done)
+{
+  return submit([done = std::move(done)](PresetStore& db)
+  {
+    auto names = std::make_shared<std::vector<std::string>>(db.listPresets());
+    return std::function<void()>([done, names] { if (done) done(*names); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::findPresets(PresetStore::Query query, PageCallback done)
+{
+  return submit([query = std::move(query), done = std::move(done)](PresetStore& db)
+  {
+    auto page = std::make_shared<PresetStore::Page>(db.findPresets(query));
+    return std::function<void()>([done, page] { if (done) done(*page); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::importBank(juce::File bankFile, BankCallback done)
+{
+  return submit([bankFile = std::move(bankFile), done = std::move(done)](PresetStore& db)
+  {
+    // Pages come in from disk as the import reads them; the bank is never
+    // copied into memory as a whole.
+    const juce::MemoryMappedFile mapped(bankFile, juce::MemoryMappedFile::readOnly);
+    size_t imported = 0;
+    const bool ok = mapped.getData() != nullptr
+                    && db.importBank(mapped.getData(), mapped.getSize(), imported);
+    return std::function<void()>([done, ok, imported] { if (done) done(ok, imported); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::exportBank(juce::File bankFile, BankCallback done)
+{
+  return submit([bankFile = std::move(bankFile), done = std::move(done)](PresetStore& db)
+  {
+    size_t exported = 0;
+    const bool ok = db.exportBank(bankFile.getFullPathName().toStdString(), exported);
+    return std::function<void()>([done, ok, exported] { if (done) done(ok, exported); });
+  });
+}
+
+PresetWorker::Ticket PresetWorker::submit(Job job)
+{
+  Ticket ticket;
+  {
+    const std::lock_guard<std::mutex> guard(lock);
+    ticket = nextTicket++;
+    queue.push_back({ ticket, std::move(job) });
+    live.emplace(ticket, std::make_shared<std::atomic<bool>>(false));
+  }
+  notify();
+  return ticket;
+}
+
+void PresetWorker::cancel(Ticket ticket)
+{
+  const std::lock_guard<std::mutex> guard(lock);
+
+  const auto found = live.find(ticket);
+  if (found == live.end())
+    return; // already delivered
+
+  found->second->store(true);
+  live.erase(found);
+
+  for (auto it = queue.begin(); it != queue.end(); ++it)
+  {
+    if (it->ticket == ticket)
+    {
+      queue.erase(it);
+      break;
+    }
+  }
+}
+
+void PresetWorker::cancelAll()
+{
+  const std::lock_guard<std::mutex> guard(lock);
+  for (auto& entry : live)
+    entry.second->store(true);
+  live.clear();
+  queue.clear();
+}
+
+void PresetWorker::run()
+{
+  while (!threadShouldExit())
+  {
+    Request request;
+    CancelFlag cancelled;
+    {
+      const std::lock_guard<std::mutex> guard(lock);
+      if (!queue.empty())
+      {
+        request = std::move(queue.front());
+        queue.pop_front();
+        cancelled = live[request.ticket];
+      }
+    }
+
+    if (!request.job)
+    {
+      wait(-1);
+      continue;
+    }
+
+    // The first request pays for opening the database, off the UI thread.
+    if (!store.isOpen())
+    {
+      databaseFile.getParentDirectory().createDirectory();
+      if (!store.open(databaseFile.getFullPathName().toStdString()))
+        DBG("Preset database unavailable: " << store.lastError());
+    }
+
+    auto completion = request.job(store);
+    deliver(request.ticket, cancelled, std::move(completion));
+  }
+}
+
+void PresetWorker::deliver(Ticket ticket, const CancelFlag& cancelled, std::function<void()> completion)
+{
+  if (cancelled->load())
+    return;
+
+  // The flag outlives the worker, so a callback queued just before the
+  // worker (and its owner) is destroyed is dropped instead of run.
+  juce::MessageManager::callAsync([this, ticket, cancelled, completion = std::move(completion)]
+  {
+    if (cancelled->load())
+      return;
+
+    {
+      const std::lock_guard<std::mutex> guard(lock);
+      live.erase(ticket);
+    }
+    completion();
+  });
+}
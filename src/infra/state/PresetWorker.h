@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetStore.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+  PresetWorker
+  ------------
+  Runs all PresetStore (SQLite) calls on a background thread so a slow disk
+  or a big library never freezes the DAW's UI.
+
+  How it works:
+  - The message thread submits requests (save/load/delete/list). Each one
+    returns a Ticket right away.
+  - The worker thread runs requests one at a time, in order, against its
+    own PresetStore (opened on the worker on first use).
+  - The result is posted back to the message thread with
+    MessageManager::callAsync, where the completion callback runs.
+  - cancel(ticket) drops a request that hasn't started, and suppresses the
+    callback of one that is running or already finished but not yet
+    delivered. Use it for stale work, e.g. a load for a preset the user has
+    already scrolled past.
+
+  Web-dev analogy: fetch() with an AbortController, and .then() always runs
+  on the UI thread.
+
+  Threading: submit/cancel from the message thread only. Callbacks never
+  run after cancel() or after the worker is destroyed.
+*/
+class PresetWorker : private juce::Thread
+{
+public:
+  using Ticket = uint64_t;
+
+  using SaveCallback = std::function<void(bool ok)>;
+  using LoadCallback = std::function<void(bool found, const std::string& blob)>;
+  using DeleteCallback = std::function<void(bool ok)>;
+  using ListCallback = std::function<void(const std::vector<std::string>& names)>;
+  using PageCallback = std::function<void(const PresetStore::Page& page)>;
+  using BankCallback = std::function<void(bool ok, size_t numPresets)>;
+
+  explicit PresetWorker(juce::File databaseFile);
+  ~PresetWorker() override;
+
+  Ticket savePreset(std::string name, std::string blob, SaveCallback done = {},
+                    std::string tags = {});
+  Ticket loadPreset(std::string name, LoadCallback done);
+  Ticket deletePreset(std::string name, DeleteCallback done = {});
+  Ticket listPresets(ListCallback done);
+  // One bounded page of a browse/search; pass page.next to get the next.
+  Ticket findPresets(PresetStore::Query query, PageCallback done);
+
+  // Whole-library moves (see PresetBank.h). The import memory-maps the
+  // bank and commits it in one transaction.
+  Ticket importBank(juce::File bankFile, BankCallback done = {});
+  Ticket exportBank(juce::File bankFile, BankCallback done = {});
+
+  // Runs on the worker; returns what to run on the message thread.
+  using Job = std::function<std::function<void()>(PresetStore&)>;
+
+  // Any other store work (see PresetLibrary), same ordering and
+  // cancellation rules as the calls above.
+  Ticket submit(Job job);
+
+  void cancel(Ticket ticket);
+  void cancelAll();
+
+private:
+  using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+  struct Request
+  {
+    Ticket ticket { 0 };
+    Job job;
+  };
+
+  void run() override;
+  void deliver(Ticket ticket, const CancelFlag& cancelled, std::function<void()> completion);
+
+  juce::File databaseFile;
+  PresetStore store; // worker thread only
+
+  std::mutex lock;
+  std::deque<Request> queue;
+  // Every request from submit() until its callback is delivered or dropped.
+  std::unordered_map<Ticket, CancelFlag> live;
+  Ticket nextTicket { 1 };
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetWorker)
+};
@@ -0,0 +1,70 @@
+/**
+  SnapshotExchange.cpp
+  --------------------
+  Pointer handoff + deferred reclamation for preset snapshots.
+*/
+#include "SnapshotExchange.h"
+
+#include <cassert>
+
+namespace state
+{
+SnapshotExchange::~SnapshotExchange()
+{
+  // Audio has stopped by now (the owning processor is being destroyed).
+  delete pending.exchange(nullptr);
+  delete active;
+  collectGarbage();
+}
+
+uint32_t SnapshotExchange::publish(std::unique_ptr<ParameterSnapshot> snapshot)
+{
+  collectGarbage();
+
+  const uint32_t generation = nextGeneration++;
+  snapshot->generation = generation;
+
+  // Whatever we get back was never seen by the audio thread.
+  delete pending.exchange(snapshot.release(), std::memory_order_acq_rel);
+  return generation;
+}
+
+void SnapshotExchange::markSynced(uint32_t generation)
+{
+  syncedGeneration.store(generation, std::memory_order_release);
+}
+
+void SnapshotExchange::collectGarbage()
+{
+  ParameterSnapshot* snapshot = nullptr;
+  while (retired.pop(snapshot))
+    delete snapshot;
+}
+
+const ParameterSnapshot* SnapshotExchange::acquire()
+{
+  if (auto* incoming = pending.exchange(nullptr, std::memory_order_acq_rel))
+  {
+    if (active != nullptr)
+      retire(active);
+    active = incoming;
+  }
+  else if (active != nullptr
+           && syncedGeneration.load(std::memory_order_acquire) >= active->generation)
+  {
+    // The parameters now hold these values; back to reading them.
+    retire(active);
+    active = nullptr;
+  }
+  return active;
+}
+
+void SnapshotExchange::retire(ParameterSnapshot* snapshot)
+{
+  // Can't fail while there is one publisher (see the header): the ring
+  // has room for every snapshot that can retire between two drains.
+  const bool queued = retired.push(snapshot);
+  assert(queued && "more snapshots in flight than the retired ring holds");
+  (void) queued;
+}
+}
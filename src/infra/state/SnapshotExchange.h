@@ -0,0 +1,83 @@
+#pragma once
+
+#include "StateCodec.h"
+#include "infra/concurrency/SpscRing.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+  SnapshotExchange
+  ----------------
+  Hands a whole preset to the audio thread at once.
+
+  Loading a preset by setting parameters one by one lets an audio block
+  see half of it (new gain, old trim) and start each ramp at a different
+  time. Instead:
+  1) The message thread decodes the preset into an immutable
+     ParameterSnapshot (all values, allocated off the audio thread) and
+     publish()es it with a single atomic pointer swap.
+  2) At the start of a block the audio thread acquire()s it and uses ONLY
+     the snapshot's values for that block and the following ones, so every
+     smoother retargets in the same block.
+  3) The message thread then updates the APVTS parameters (UI + host) and
+     calls markSynced(). From the next block on the audio thread reads the
+     parameters again and retires the snapshot.
+  4) Retired snapshots go back through an SPSC ring and are deleted on the
+     message thread (next publish / collectGarbage()). The audio thread
+     never allocates or frees.
+
+  A snapshot that is replaced before the audio thread picked it up is
+  deleted directly by publish(): the audio thread never saw it.
+
+  Threads: exactly one publisher thread calls publish(), markSynced() and
+  collectGarbage() (the message thread; nextGeneration is a plain counter)
+  and exactly one audio thread calls acquire().
+*/
+namespace state
+{
+struct ParameterSnapshot
+{
+  uint32_t generation { 0 };
+  size_t count { 0 };
+  std::array<float, kMaxParams> values {}; // params::getAll() order
+};
+
+class SnapshotExchange
+{
+public:
+  SnapshotExchange() = default;
+  ~SnapshotExchange();
+
+  // Publisher thread only. Returns the generation to pass to markSynced().
+  uint32_t publish(std::unique_ptr<ParameterSnapshot> snapshot);
+  void markSynced(uint32_t generation);
+  void collectGarbage();
+
+  // Audio thread, once per block. Returns the snapshot whose values this
+  // block must use, or nullptr to read the parameters as usual.
+  const ParameterSnapshot* acquire();
+
+private:
+  void retire(ParameterSnapshot* snapshot);
+
+  std::atomic<ParameterSnapshot*> pending { nullptr };
+  std::atomic<uint32_t> syncedGeneration { 0 };
+  uint32_t nextGeneration { 1 }; // publisher thread
+
+  ParameterSnapshot* active { nullptr }; // audio thread
+
+  // Every publish() drains the ring first. Only snapshots the audio thread
+  // has made active are retired, and each is retired once. So between two
+  // drains at most three can arrive: the one active at the drain, the one
+  // still pending then, and the one this publish() adds.
+  static constexpr size_t kMaxRetiredBetweenDrains = 3;
+  concurrency::SpscRing<ParameterSnapshot*, 4> retired;
+  static_assert(decltype(retired)::capacity() >= kMaxRetiredBetweenDrains, "retired ring too small");
+
+  SnapshotExchange(const SnapshotExchange&) = delete;
+  SnapshotExchange& operator=(const SnapshotExchange&) = delete;
+};
+}
@@ -0,0 +1,178 @@
+/**
+  StateCodec.cpp
+  --------------
+  Binary state encode/decode + the renamed-parameter table. See StateCodec.h.
+*/
+#include "StateCodec.h"
+
+#include "infra/parameters/ParameterRegistry.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace state
+{
+namespace
+{
+constexpr uint32_t kMagic = 0x54534750; // "PGST" when read as bytes
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kRecordSize = 8;
+
+static_assert(params::kNumParams <= kMaxParams, "raise kMaxParams");
+
+void writeU16(uint8_t* p, uint16_t v)
+{
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+}
+
+void writeU32(uint8_t* p, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i)
+    p[i] = (uint8_t) (v >> (8 * i));
+}
+
+uint16_t readU16(const uint8_t* p)
+{
+  return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+uint32_t floatBits(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float bitsToFloat(uint32_t bits)
+{
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Parameters that were renamed (or replaced by a new one with other
+// units). A record written under `from` is read into `to` as
+// value * scale + offset. Add an entry when an id changes, e.g.
+//   { "trim", "output", 1.0f, 0.0f }
+// Records whose id is neither in the registry nor listed here (removed
+// parameters) are ignored.
+struct RenamedParam
+{
+  const char* from;
+  const char* to;
+  float scale;
+  float offset;
+};
+
+constexpr std::array<RenamedParam, 0> kRenamedParams {};
+
+// Resolved at compile time; a `to` that isn't in the registry fails the build.
+constexpr auto kRenamedTargets = [] {
+  std::array<size_t, kRenamedParams.size()> targets {};
+  for (size_t i = 0; i < kRenamedParams.size(); ++i)
+    targets[i] = params::indexOf(kRenamedParams[i].to);
+  return targets;
+}();
+static_assert([] {
+  for (size_t target : kRenamedTargets)
+    if (target >= params::kNumParams)
+      return false;
+  return true;
+}(), "renamed parameter points at an id that is not in the registry");
+
+// A record whose id is not in the registry any more.
+void migrateRecord(uint32_t idHash, float value, float* values, size_t numValues)
+{
+  for (size_t i = 0; i < kRenamedParams.size(); ++i)
+  {
+    if (params::hashId(kRenamedParams[i].from) == idHash && kRenamedTargets[i] < numValues)
+    {
+      values[kRenamedTargets[i]] = value * kRenamedParams[i].scale + kRenamedParams[i].offset;
+      return;
+    }
+  }
+}
+}
+
+bool isBinaryState(const void* data, size_t size)
+{
+  return data != nullptr && size >= kHeaderSize && readU32(static_cast<const uint8_t*>(data)) == kMagic;
+}
+
+size_t encodedSize(size_t numValues)
+{
+  return kHeaderSize + numValues * kRecordSize;
+}
+
+void encode(const float* values, size_t numValues, void* out)
+{
+  auto* p = static_cast<uint8_t*>(out);
+
+  writeU32(p, kMagic);
+  writeU16(p + 4, kFormatVersion);
+  writeU16(p + 6, (uint16_t) numValues);
+  p += kHeaderSize;
+
+  for (size_t i = 0; i < numValues; ++i, p += kRecordSize)
+  {
+    writeU32(p, params::kIdHashes[i]);
+    writeU32(p + 4, floatBits(values[i]));
+  }
+}
+
+bool decode(const void* data, size_t size, float* values, size_t numValues)
+{
+  if (!isBinaryState(data, size))
+    return false;
+
+  // Newer versions are read too: records are self-describing, and unknown
+  // ids go through the renamed-parameter table.
+  const auto* p = static_cast<const uint8_t*>(data);
+  const size_t count = readU16(p + 6);
+  if (size < encodedSize(count))
+    return false;
+
+  // The registry's id hashes are computed at compile time.
+  const auto& hashes = params::kIdHashes;
+  numValues = numValues < hashes.size() ? numValues : hashes.size();
+
+  p += kHeaderSize;
+  for (size_t r = 0; r < count; ++r, p += kRecordSize)
+  {
+    const uint32_t idHash = readU32(p);
+    const float value = bitsToFloat(readU32(p + 4));
+
+    // NaN/Inf can't be a parameter value (corrupt or hand-edited data):
+    // keep what the caller pre-filled, as if the record were missing.
+    if (!std::isfinite(value))
+      continue;
+
+    // Records are written in registry order, so the same slot usually hits.
+    bool matched = false;
+    if (r < numValues && hashes[r] == idHash)
+    {
+      values[r] = value;
+      matched = true;
+    }
+    for (size_t i = 0; i < numValues && !matched; ++i)
+    {
+      if (hashes[i] == idHash)
+      {
+        values[i] = value;
+        matched = true;
+      }
+    }
+
+    if (!matched)
+      migrateRecord(idHash, value, values, numValues);
+  }
+  return true;
+}
+}
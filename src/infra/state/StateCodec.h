@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+  StateCodec
+  ----------
+  Compact, versioned binary format for the plugin state (host sessions and
+  presets), replacing the ValueTree -> XML -> text round-trip.
+
+  Layout (little-endian, fixed size for a given parameter count):
+    offset 0  uint32  magic "PGST"
+    offset 4  uint16  format version
+    offset 6  uint16  record count N
+    offset 8  N x { uint32 id hash, float32 value }
+
+  - Records are keyed by params::hashId(id), not by position, so adding,
+    removing or reordering parameters never shifts other values.
+  - Parameters missing from the data keep the value the caller pre-filled
+    (usually the default) -> added parameters "just work".
+  - Non-finite values (NaN, Inf) are treated as missing.
+  - Records whose id is no longer in the registry are looked up in the
+    renamed-parameter table in StateCodec.cpp (renames, unit changes);
+    ids not listed there (removed parameters) are ignored.
+
+  Values are passed as one float per params::getAll() entry, in registry
+  order (plain parameter values, not normalised 0..1).
+*/
+namespace state
+{
+constexpr uint16_t kFormatVersion = 1;
+
+// Upper bound for stack buffers of parameter values.
+constexpr size_t kMaxParams = 64;
+
+// True if the data starts with the binary header (otherwise try legacy XML).
+bool isBinaryState(const void* data, size_t size);
+
+size_t encodedSize(size_t numValues);
+
+// Writes encodedSize(numValues) bytes to `out`.
+void encode(const float* values, size_t numValues, void* out);
+
+// Overwrites values[i] for every parameter found in the data. Returns
+// false (and leaves `values` untouched) if the data is not valid state.
+bool decode(const void* data, size_t size, float* values, size_t numValues);
+}
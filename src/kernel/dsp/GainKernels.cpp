@@ -0,0 +1,245 @@
+/**
+  GainKernels.cpp
+  ---------------
+  Scalar reference kernels + runtime selection of the SIMD variant.
+
+  The SIMD bodies live in SimdKernels.h and are compiled once per
+  instruction set under arch/. This file is built with the baseline flags
+  and only asks xsimd which of those variants the CPU can run.
+*/
+#include "GainKernels.h"
+#include "SimdKernelSelector.h"
+#include "TruePeakDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef PROGAIN_FORCE_SIMD_ARCH
+  #define PROGAIN_FORCE_SIMD_ARCH "auto"
+#endif
+
+#if PROGAIN_SIMD_SSE2 || PROGAIN_SIMD_NEON
+  #define PROGAIN_HAS_SIMD_KERNELS 1
+#else
+  #define PROGAIN_HAS_SIMD_KERNELS 0
+#endif
+
+namespace dsp
+{
+namespace
+{
+template <typename Sample>
+void accumulate(ChannelStats& stats, Sample v)
+{
+  const Sample magnitude = std::abs(v);
+  stats.peak = std::max(stats.peak, (float) magnitude);
+  stats.sumSquares += (float) (v * v);
+  stats.clips += magnitude > Sample(1) ? 1u : 0u;
+}
+
+template <typename Sample>
+void scalarConstant(Sample* data, int numSamples, float gain, ChannelStats& stats)
+{
+  for (int i = 0; i < numSamples; ++i)
+  {
+    const Sample v = data[i] * (Sample) gain;
+    data[i] = v;
+    accumulate(stats, v);
+  }
+}
+
+template <typename Sample>
+void scalarRamp(Sample* data, int numSamples, const RampSegment& segment, ChannelStats& stats)
+{
+  Sample expGain = segment.expStart;
+  for (int i = 0; i < numSamples; ++i)
+  {
+    const Sample linearGain = (Sample) segment.linearStart + (Sample) i * (Sample) segment.linearStep;
+    const Sample v = data[i] * (linearGain * expGain);
+    data[i] = v;
+    accumulate(stats, v);
+    expGain *= (Sample) segment.expRatio;
+  }
+}
+
+template <typename Sample>
+void scalarMeasure(const Sample* data, int numSamples, ChannelStats& stats)
+{
+  for (int i = 0; i < numSamples; ++i)
+    accumulate(stats, data[i]);
+}
+
+template <typename Sample>
+bool scalarIsSilent(const Sample* data, int numSamples)
+{
+  for (int i = 0; i < numSamples; ++i)
+    if (data[i] != Sample(0))
+      return false;
+  return true;
+}
+
+template <typename Sample>
+float scalarTruePeak(const Sample* samples, int numSamples)
+{
+  using Filter = TruePeakFilter;
+  Sample peak = 0;
+  for (int i = 0; i < numSamples; ++i)
+  {
+    for (int phase = 0; phase < Filter::kPhases; ++phase)
+    {
+      Sample y = 0;
+      for (int k = 0; k < Filter::kTapsPerPhase; ++k)
+        y += (Sample) Filter::kCoefficients[phase][k] * samples[i - k];
+      peak = std::max(peak, std::abs(y));
+    }
+  }
+  return (float) peak;
+}
+
+template <typename Sample>
+const BasicGainKernels<Sample> kScalar { "scalar", scalarConstant<Sample>, scalarRamp<Sample>,
+                                         scalarMeasure<Sample>, scalarIsSilent<Sample>,
+                                         scalarTruePeak<Sample> };
+
+#if PROGAIN_HAS_SIMD_KERNELS
+// Widest first: xsimd::dispatch() takes the first entry the CPU supports.
+// The baseline (SSE2 on x86-64, NEON on AArch64) is always last.
+using DispatchArchs = xsimd::arch_list<
+  #if PROGAIN_SIMD_AVX512
+  xsimd::avx512f,
+  #endif
+  #if PROGAIN_SIMD_AVX2
+  xsimd::avx2,
+  #endif
+  #if PROGAIN_SIMD_SSE2
+  xsimd::sse2
+  #else
+  xsimd::neon64
+  #endif
+  >;
+
+// Honour -DPROGAIN_SIMD_ARCH=<name> when the CPU can actually run it.
+template <typename Sample>
+const BasicGainKernels<Sample>* findForcedKernels(const char* forced)
+{
+  const auto cpu = xsimd::available_architectures();
+  SimdKernelSelector<Sample> select;
+
+  #if PROGAIN_SIMD_AVX512
+  if (std::strcmp(forced, "avx512") == 0 && cpu.avx512f)
+    return select(xsimd::avx512f {});
+  #endif
+  #if PROGAIN_SIMD_AVX2
+  if (std::strcmp(forced, "avx2") == 0 && cpu.avx2)
+    return select(xsimd::avx2 {});
+  #endif
+  #if PROGAIN_SIMD_SSE2
+  if (std::strcmp(forced, "sse2") == 0 && cpu.sse2)
+    return select(xsimd::sse2 {});
+  #endif
+  #if PROGAIN_SIMD_NEON
+  if (std::strcmp(forced, "neon") == 0 && cpu.neon64)
+    return select(xsimd::neon64 {});
+  #endif
+  return nullptr;
+}
+#endif
+}
+
+template <typename Sample>
+const BasicGainKernels<Sample>& scalarKernels()
+{
+  return kScalar<Sample>;
+}
+
+template <typename Sample>
+const BasicGainKernels<Sample>& selectSimdKernels()
+{
+  const char* forced = PROGAIN_FORCE_SIMD_ARCH;
+  if (std::strcmp(forced, "scalar") == 0)
+    return kScalar<Sample>;
+
+#if PROGAIN_HAS_SIMD_KERNELS
+  if (std::strcmp(forced, "auto") != 0)
+  {
+    if (const auto* kernels = findForcedKernels<Sample>(forced))
+      return *kernels;
+  }
+
+  static const BasicGainKernels<Sample>* best =
+    xsimd::dispatch<DispatchArchs>(SimdKernelSelector<Sample> {})();
+  return *best;
+#else
+  return kScalar<Sample>;
+#endif
+}
+
+template <typename Sample>
+std::vector<const BasicGainKernels<Sample>*> runnableSimdKernels()
+{
+  std::vector<const BasicGainKernels<Sample>*> tables;
+#if PROGAIN_HAS_SIMD_KERNELS
+  const auto cpu = xsimd::available_architectures();
+  SimdKernelSelector<Sample> select;
+
+  #if PROGAIN_SIMD_AVX512
+  if (cpu.avx512f)
+    tables.push_back(select(xsimd::avx512f {}));
+  #endif
+  #if PROGAIN_SIMD_AVX2
+  if (cpu.avx2)
+    tables.push_back(select(xsimd::avx2 {}));
+  #endif
+  #if PROGAIN_SIMD_SSE2
+  if (cpu.sse2)
+    tables.push_back(select(xsimd::sse2 {}));
+  #endif
+  #if PROGAIN_SIMD_NEON
+  if (cpu.neon64)
+    tables.push_back(select(xsimd::neon64 {}));
+  #endif
+#endif
+  return tables;
+}
+
+template const GainKernels& scalarKernels<float>();
+template const GainKernels64& scalarKernels<double>();
+template const GainKernels& selectSimdKernels<float>();
+template const GainKernels64& selectSimdKernels<double>();
+template std::vector<const GainKernels*> runnableSimdKernels<float>();
+template std::vector<const GainKernels64*> runnableSimdKernels<double>();
+
+std::string describeSimdSupport()
+{
+  std::string compiled = "scalar";
+#if PROGAIN_SIMD_SSE2
+  compiled += " sse2";
+#endif
+#if PROGAIN_SIMD_AVX2
+  compiled += " avx2";
+#endif
+#if PROGAIN_SIMD_AVX512
+  compiled += " avx512f";
+#endif
+#if PROGAIN_SIMD_NEON
+  compiled += " neon64";
+#endif
+
+  std::string cpu;
+#if PROGAIN_HAS_SIMD_KERNELS
+  const auto archs = xsimd::available_architectures();
+  #if PROGAIN_SIMD_SSE2
+  if (archs.sse2) cpu += " sse2";
+  if (archs.avx2) cpu += " avx2";
+  if (archs.avx512f) cpu += " avx512f";
+  #else
+  if (archs.neon64) cpu += " neon64";
+  #endif
+#endif
+
+  return "compiled: " + compiled
+       + " | cpu:" + (cpu.empty() ? std::string(" unknown") : cpu)
+       + " | forced: " + PROGAIN_FORCE_SIMD_ARCH;
+}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+  GainKernels
+  -----------
+  The per-channel inner loops of the gain stage.
+
+  Every kernel works on ONE channel at a time, walking the samples in order
+  (sample-major), and fuses two jobs into a single pass over memory:
+  - multiply each sample by the gain
+  - accumulate meter statistics of the result (peak, energy, clips)
+
+  While a parameter is moving, the gain is described by a RampSegment (see
+  GainSmoother) instead of a per-sample buffer, so ramps cost one extra add
+  and multiply per sample and no memory traffic.
+
+  Two read-only helpers back the processor's fast paths:
+  - measure(): the meter statistics alone, for a settled gain of exactly
+    1.0 (the buffer is already the output, so nothing is written)
+  - isSilent(): true if every sample is exactly zero; it stops at the first
+    non-zero batch, so on real audio it costs a few loads
+
+  The table also carries the 4x true-peak interpolator (read-only; it runs
+  on the output after the gain kernels when true-peak metering is on).
+
+  Every kernel exists for float and for double samples (GainKernels and
+  GainKernels64), generated from the same templated code.
+
+  There are two families that agree to within float rounding:
+  - scalarKernels(): plain C++ loops. This is the reference you can read
+    and trust when comparing output.
+  - selectSimdKernels(): the same math using xsimd batches. The SIMD code
+    is compiled several times (SSE2 / AVX2 / AVX-512 on x86, NEON on ARM)
+    and the best variant the CPU supports is picked at runtime.
+
+  The processor calls selectSimdKernels() once in prepareToPlay(); see
+  ProGainAudioProcessor::setUseReferenceKernels() to force the scalar path.
+*/
+namespace dsp
+{
+// Meter statistics of one channel's output. Kernels add to it, so one
+// instance can span several calls (e.g. all segments of a block).
+struct ChannelStats
+{
+  float peak { 0.0f };       // max |output|
+  float sumSquares { 0.0f }; // sum of output^2 (RMS = sqrt(sumSquares / n))
+  uint32_t clips { 0 };      // samples with |output| > 1.0 (0 dBFS)
+};
+
+// Gain of sample i within a segment:
+//   (linearStart + i * linearStep) * (expStart * expRatio^i)
+struct RampSegment
+{
+  float linearStart;
+  float linearStep;
+  float expStart;
+  float expRatio;
+};
+
+// One family of kernels for one sample type. The gain (float) and the
+// meter statistics are the same for both; only the audio is float or
+// double, so the 64-bit path keeps full precision end to end.
+template <typename Sample>
+struct BasicGainKernels
+{
+  // Multiplies `data` by a constant `gain` in place.
+  using ConstantGainFn = void (*)(Sample* data, int numSamples, float gain, ChannelStats& stats);
+
+  // Multiplies data[i] by the segment's gain for sample i in place.
+  using RampGainFn = void (*)(Sample* data, int numSamples, const RampSegment& segment,
+                              ChannelStats& stats);
+
+  // Meter statistics of `data` as it is (gain 1.0). Does not modify data.
+  using MeasureFn = void (*)(const Sample* data, int numSamples, ChannelStats& stats);
+
+  // True if all numSamples samples are +0.0 or -0.0 (digital silence).
+  using IsSilentFn = bool (*)(const Sample* data, int numSamples);
+
+  // Peak |y| of the 4x-oversampled signal (BS.1770 polyphase FIR, see
+  // TruePeakDetector) for input samples[0 .. numSamples). Reads back to
+  // samples[-11], which must hold the preceding input. Does not modify data.
+  using TruePeakFn = float (*)(const Sample* samples, int numSamples);
+
+  const char* name;
+  ConstantGainFn applyConstant;
+  RampGainFn applyRamp;
+  MeasureFn measure;
+  IsSilentFn isSilent;
+  TruePeakFn truePeak;
+};
+
+using GainKernels = BasicGainKernels<float>;
+// For hosts with a 64-bit mix engine (processBlock(AudioBuffer<double>&)).
+using GainKernels64 = BasicGainKernels<double>;
+
+// Both families are compiled for float and double; scalarKernels() alone
+// means the float one.
+template <typename Sample = float>
+const BasicGainKernels<Sample>& scalarKernels();
+
+// Picks the widest SIMD variant this CPU supports (CPUID via xsimd), or the
+// variant forced at configure time with -DPROGAIN_SIMD_ARCH=<name>.
+// Falls back to scalarKernels() when no SIMD variant was compiled in.
+// Not real-time safe on first call; call it from prepareToPlay().
+template <typename Sample = float>
+const BasicGainKernels<Sample>& selectSimdKernels();
+
+// Every compiled SIMD variant this CPU can run, widest first; empty when
+// none was compiled in. For checks that hold each one against
+// scalarKernels() (ProGainBench --check-kernels).
+template <typename Sample = float>
+std::vector<const BasicGainKernels<Sample>*> runnableSimdKernels();
+
+// Human-readable summary of what was compiled in, what the CPU supports and
+// what was forced, e.g. "compiled: sse2 avx2 avx512f | cpu: sse2 avx2 | forced: auto".
+std::string describeSimdSupport();
+}
@@ -0,0 +1,132 @@
+/**
+  GainSmoother.cpp
+  ----------------
+  Linear parameter ramps turned into gain-domain segments for the kernels.
+  See GainSmoother.h for the math.
+*/
+#include "GainSmoother.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dsp
+{
+namespace
+{
+float decibelsToGain(float db)
+{
+  return std::pow(10.0f, db * 0.05f);
+}
+
+int stepsFor(double sampleRate, float seconds)
+{
+  return (int) std::floor(sampleRate * (double) seconds);
+}
+}
+
+void GainSmoother::LinearRamp::setCurrentAndTarget(float value)
+{
+  current = target = value;
+  step = 0.0f;
+  countdown = 0;
+}
+
+void GainSmoother::LinearRamp::setTarget(float value)
+{
+  if (value == target)
+    return;
+
+  if (stepsToTarget <= 0)
+  {
+    setCurrentAndTarget(value);
+    return;
+  }
+
+  target = value;
+  countdown = stepsToTarget;
+  step = (target - current) / (float) countdown;
+}
+
+void GainSmoother::LinearRamp::advance(int numSamples)
+{
+  if (numSamples >= countdown)
+  {
+    current = target;
+    step = 0.0f;
+    countdown = 0;
+    return;
+  }
+
+  // Measured back from the target rather than accumulated, so float
+  // rounding doesn't build up over a long ramp.
+  countdown -= numSamples;
+  current = target - step * (float) countdown;
+}
+
+void GainSmoother::reset(double sampleRate, float gainRampSeconds, float trimRampSeconds)
+{
+  gain.stepsToTarget = stepsFor(sampleRate, gainRampSeconds);
+  trimDb.stepsToTarget = stepsFor(sampleRate, trimRampSeconds);
+  gain.setCurrentAndTarget(gain.target);
+  trimDb.setCurrentAndTarget(trimDb.target);
+}
+
+void GainSmoother::setCurrentAndTargetValue(float newGain, float newTrimDb)
+{
+  gain.setCurrentAndTarget(newGain);
+  trimDb.setCurrentAndTarget(newTrimDb);
+}
+
+void GainSmoother::setTargetValue(float newGain, float newTrimDb)
+{
+  gain.setTarget(newGain);
+  trimDb.setTarget(newTrimDb);
+}
+
+float GainSmoother::getTargetGain() const
+{
+  return gain.target * decibelsToGain(trimDb.target);
+}
+
+int GainSmoother::nextSegment(int maxSamples, RampSegment& segment)
+{
+  int length = std::min(maxSamples, kMaxSegmentLength);
+  if (gain.countdown > 0)
+    length = std::min(length, gain.countdown);
+  if (trimDb.countdown > 0)
+    length = std::min(length, trimDb.countdown);
+
+  // Sample 0 of the segment is one step past the current value, matching
+  // SmoothedValue::getNextValue().
+  if (gain.countdown > 0)
+  {
+    segment.linearStart = gain.current + gain.step;
+    segment.linearStep = gain.step;
+  }
+  else
+  {
+    segment.linearStart = gain.target;
+    segment.linearStep = 0.0f;
+  }
+
+  if (trimDb.countdown > 0)
+  {
+    segment.expStart = decibelsToGain(trimDb.current + trimDb.step);
+    segment.expRatio = decibelsToGain(trimDb.step);
+  }
+  else
+  {
+    segment.expStart = decibelsToGain(trimDb.target);
+    segment.expRatio = 1.0f;
+  }
+
+  skip(length);
+  return length;
+}
+
+void GainSmoother::skip(int numSamples)
+{
+  gain.advance(numSamples);
+  trimDb.advance(numSamples);
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "GainKernels.h"
+
+/**
+  GainSmoother
+  ------------
+  Smooths the gain (linear) and trim (dB) parameters together and hands the
+  kernels ready-made ramps in the gain domain, so the audio thread never
+  calls pow() per sample.
+
+  How it works:
+  - Both parameters ramp linearly in their own units over their smoothing
+    time, exactly like juce::SmoothedValue<Linear>.
+  - A linear ramp in dB is an exponential ramp in gain: every sample the
+    trim gain is multiplied by the same ratio (10^(stepDb / 20)).
+  - So the combined gain of each sample is
+        (gainStart + i * gainStep) * (trimStart * trimRatio^i)
+    which the kernels evaluate with one add and one multiply per sample.
+  - nextSegment() hands out at most kMaxSegmentLength samples at a time and
+    re-anchors the ramp at each segment start from values measured back
+    from the target, so rounding never accumulates over a long ramp.
+
+  Accuracy: against an exact double-precision ramp (input in [-1, 1],
+  random automation over the full gain/trim range) the output is within
+  4e-5 absolute, about -88 dB: ~2.5e-5 at the default 20 ms smoothing,
+  ~1e-5 for 1-5 s ramps. Most of it is the float trim ratio raised to the
+  power of up to 63 on steep trim ramps at gains near 8x.
+  `ProGainBench --check-smoother` measures it and fails above the bound.
+  The ramp is continuous across segment and block boundaries, so it stays
+  click-free.
+
+  Once neither parameter is moving, isSmoothing() returns false and the
+  processor applies getTargetGain() as one constant multiply.
+*/
+namespace dsp
+{
+class GainSmoother
+{
+public:
+  // Control-rate re-anchoring interval (samples).
+  static constexpr int kMaxSegmentLength = 64;
+
+  void reset(double sampleRate, float gainRampSeconds, float trimRampSeconds);
+
+  void setCurrentAndTargetValue(float gain, float trimDb);
+  void setTargetValue(float gain, float trimDb);
+
+  bool isSmoothing() const { return gain.countdown > 0 || trimDb.countdown > 0; }
+
+  // Settled combined gain: gain * decibelsToGain(trimDb).
+  float getTargetGain() const;
+
+  // Describes the next stretch of up to maxSamples samples (never more
+  // than kMaxSegmentLength, never past the point where a ramp settles) and
+  // advances past it. Returns the number of samples the segment covers.
+  int nextSegment(int maxSamples, RampSegment& segment);
+
+  // Advances without producing a segment (e.g. when the audio is skipped).
+  void skip(int numSamples);
+
+private:
+  struct LinearRamp
+  {
+    float current { 0.0f };
+    float target { 0.0f };
+    float step { 0.0f };
+    int countdown { 0 };
+    int stepsToTarget { 0 };
+
+    void setCurrentAndTarget(float value);
+    void setTarget(float value);
+    void advance(int numSamples);
+  };
+
+  LinearRamp gain;
+  LinearRamp trimDb;
+};
+}
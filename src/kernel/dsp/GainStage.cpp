@@ -0,0 +1,90 @@
+/**
+  GainStage.cpp
+  -------------
+  The block-level gain loop, instantiated per channel count and sample
+  type.
+*/
+#include "GainStage.h"
+
+namespace dsp
+{
+namespace
+{
+// NumChannels == 0: read the count from the block.
+template <typename Sample, int NumChannels>
+bool runGainStage(const BasicGainKernels<Sample>& kernels, GainSmoother& smoother,
+                  const BasicGainBlock<Sample>& block)
+{
+  const int numChannels = NumChannels > 0 ? NumChannels : block.numChannels;
+  const int numSamples = block.numSamples;
+  Sample* const* channels = block.channels;
+
+  // Digital silence in is silence out, whatever the gain: skip the gain
+  // stage and leave the buffer alone. The smoother still advances.
+  bool silent = true;
+  for (int ch = 0; ch < numChannels && silent; ++ch)
+    silent = kernels.isSilent(channels[ch], numSamples);
+
+  if (silent)
+  {
+    smoother.skip(numSamples);
+    return true;
+  }
+
+  // Ramping: walk the block in control-rate segments, applying each one to
+  // every channel before moving on.
+  int start = 0;
+  while (start < numSamples && smoother.isSmoothing())
+  {
+    RampSegment segment;
+    const int count = smoother.nextSegment(numSamples - start, segment);
+    for (int ch = 0; ch < numChannels; ++ch)
+      kernels.applyRamp(channels[ch] + start, count, segment, block.stats[ch]);
+    start += count;
+  }
+
+  // Settled: one constant multiply per channel for the rest of the block,
+  // or at unity gain (gain 1.0, trim 0 dB) just the meter scan.
+  if (start < numSamples)
+  {
+    const float total = smoother.getTargetGain();
+    if (total == 1.0f)
+    {
+      for (int ch = 0; ch < numChannels; ++ch)
+        kernels.measure(channels[ch] + start, numSamples - start, block.stats[ch]);
+    }
+    else
+    {
+      for (int ch = 0; ch < numChannels; ++ch)
+        kernels.applyConstant(channels[ch] + start, numSamples - start, total, block.stats[ch]);
+    }
+  }
+  return false;
+}
+}
+
+template <typename Sample>
+BasicGainStageFn<Sample> selectGainStage(int numChannels)
+{
+  switch (numChannels)
+  {
+    case 1: return &runGainStage<Sample, 1>;
+    case 2: return &runGainStage<Sample, 2>;
+    case 6: return &runGainStage<Sample, 6>;
+    case 12: return &runGainStage<Sample, 12>;
+    case 16: return &runGainStage<Sample, 16>;
+    default: return genericGainStage<Sample>();
+  }
+}
+
+template <typename Sample>
+BasicGainStageFn<Sample> genericGainStage()
+{
+  return &runGainStage<Sample, 0>;
+}
+
+template BasicGainStageFn<float> selectGainStage<float>(int);
+template BasicGainStageFn<double> selectGainStage<double>(int);
+template BasicGainStageFn<float> genericGainStage<float>();
+template BasicGainStageFn<double> genericGainStage<double>();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "GainKernels.h"
+#include "GainSmoother.h"
+
+/**
+  GainStage
+  ---------
+  Runs the gain kernels over all channels of one block: the silence check,
+  the ramp segments while the smoother moves, then the settled constant
+  gain (or, at exactly 1.0, only the meter scan).
+
+  The channel loop is specialised at compile time for the channel counts
+  people actually use, so it has a fixed trip count the compiler unrolls:
+  1 (mono), 2 (stereo), 6 (5.1), 12 (7.1.4) and 16 (3rd-order
+  ambisonics). Any other count runs the same code with a runtime count.
+  Pick the variant once with selectGainStage() in prepareToPlay().
+
+  The per-sample work stays in the GainKernels table (SIMD, per channel);
+  this only decides what runs on which channel. Like the kernels, it comes
+  in a float and a double version.
+*/
+namespace dsp
+{
+template <typename Sample>
+struct BasicGainBlock
+{
+  Sample* const* channels; // numChannels pointers to numSamples samples
+  int numChannels;
+  int numSamples;
+  ChannelStats* stats;     // numChannels entries, added to
+};
+
+using GainBlock = BasicGainBlock<float>;
+
+// Returns true if the whole block was digital silence: the buffer was left
+// untouched (silence out, whatever the gain) and only the smoother moved.
+template <typename Sample>
+using BasicGainStageFn = bool (*)(const BasicGainKernels<Sample>& kernels, GainSmoother& smoother,
+                                  const BasicGainBlock<Sample>& block);
+
+using GainStageFn = BasicGainStageFn<float>;
+
+// The variant specialised for numChannels, or the generic one. Compiled
+// for float and double samples.
+template <typename Sample = float>
+BasicGainStageFn<Sample> selectGainStage(int numChannels);
+// Works for any channel count.
+template <typename Sample = float>
+BasicGainStageFn<Sample> genericGainStage();
+}
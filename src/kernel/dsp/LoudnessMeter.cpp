@@ -0,0 +1,246 @@
+/**
+  LoudnessMeter.cpp
+  -----------------
+  K-weighting filter design, 100 ms hop bookkeeping and histogram gating.
+  See LoudnessMeter.h for the overview.
+*/
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dsp
+{
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kRelativeGateLu = -10.0;
+constexpr double kBinWidthLu = 0.1;
+constexpr float kSilence = -std::numeric_limits<float>::infinity();
+
+// LUFS from a weighted mean square: -0.691 + 10 log10(z).
+double energyToLufs(double meanSquare)
+{
+  return meanSquare > 0.0 ? -0.691 + 10.0 * std::log10(meanSquare)
+                          : -std::numeric_limits<double>::infinity();
+}
+
+int binFor(double lufs, int numBins)
+{
+  const int bin = (int) std::floor((lufs - kAbsoluteGateLufs) / kBinWidthLu);
+  return std::clamp(bin, 0, numBins - 1);
+}
+
+float toReading(double lufs)
+{
+  return std::isfinite(lufs) ? (float) lufs : kSilence;
+}
+}
+
+void LoudnessMeter::prepare(double sampleRate)
+{
+  // BS.1770 stage 1: high shelf (+4 dB above ~1.7 kHz, head effects).
+  {
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(kPi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+  }
+
+  // Stage 2: RLB high-pass (~38 Hz).
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(kPi * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+    highPass.b0 = 1.0;
+    highPass.b1 = -2.0;
+    highPass.b2 = 1.0;
+    highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highPass.a2 = (1.0 - k / q + k * k) / a0;
+  }
+
+  channelWeights.fill(1.0);
+  hopLength = std::max(1, (int) std::lround(sampleRate * 0.1));
+  reset();
+}
+
+void LoudnessMeter::setChannelWeight(int channel, double weight)
+{
+  if (channel >= 0 && channel < kMaxChannels)
+    channelWeights[(size_t) channel] = weight;
+}
+
+void LoudnessMeter::reset()
+{
+  state.fill(ChannelState {});
+  hopPosition = 0;
+  hopEnergy = 0.0;
+  hops.fill(0.0);
+  hopIndex = 0;
+  hopsSinceReset = 0;
+  histogramCounts.fill(0);
+  histogramEnergy.fill(0.0);
+  gatedBlocks = 0;
+  gatedEnergy = 0.0;
+  readings = { kSilence, kSilence, kSilence, kSilence };
+}
+
+template <typename Sample>
+bool LoudnessMeter::process(const Sample* const* channels, int numChannels, int numSamples)
+{
+  numChannels = std::min(numChannels, kMaxChannels);
+  bool updated = false;
+
+  int done = 0;
+  while (done < numSamples)
+  {
+    // Filter up to the end of the current hop, one channel at a time.
+    const int count = std::min(numSamples - done, hopLength - hopPosition);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+      const Sample* input = channels[ch] + done;
+      auto& s = state[(size_t) ch];
+      double sum = 0.0;
+      for (int i = 0; i < count; ++i)
+      {
+        const double x = input[i];
+        const double y1 = shelf.b0 * x + s.shelf1;
+        s.shelf1 = shelf.b1 * x - shelf.a1 * y1 + s.shelf2;
+        s.shelf2 = shelf.b2 * x - shelf.a2 * y1;
+
+        const double y2 = highPass.b0 * y1 + s.highPass1;
+        s.highPass1 = highPass.b1 * y1 - highPass.a1 * y2 + s.highPass2;
+        s.highPass2 = highPass.b2 * y1 - highPass.a2 * y2;
+
+        sum += y2 * y2;
+      }
+      hopEnergy += channelWeights[(size_t) ch] * sum;
+    }
+
+    done += count;
+    hopPosition += count;
+    if (hopPosition == hopLength)
+    {
+      finishHop();
+      updated = true;
+    }
+  }
+  return updated;
+}
+
+template <typename Sample>
+bool LoudnessMeter::processSilence(const Sample* const* zeros, int numChannels, int numSamples)
+{
+  numChannels = std::min(numChannels, kMaxChannels);
+  if (!filtersSettled(numChannels))
+    return process(zeros, numChannels, numSamples);
+
+  // Zero in, zero state: every output sample is 0 and adds no energy.
+  for (int ch = 0; ch < numChannels; ++ch)
+    state[(size_t) ch] = ChannelState {};
+
+  bool updated = false;
+  while (numSamples > 0)
+  {
+    const int count = std::min(numSamples, hopLength - hopPosition);
+    numSamples -= count;
+    hopPosition += count;
+    if (hopPosition == hopLength)
+    {
+      finishHop();
+      updated = true;
+    }
+  }
+  return updated;
+}
+
+template bool LoudnessMeter::process(const float* const*, int, int);
+template bool LoudnessMeter::process(const double* const*, int, int);
+template bool LoudnessMeter::processSilence(const float* const*, int, int);
+template bool LoudnessMeter::processSilence(const double* const*, int, int);
+
+bool LoudnessMeter::filtersSettled(int numChannels) const
+{
+  // Below this the filter output is < -200 dBFS, far under the -70 LUFS
+  // gate; treating it as exactly 0 can't change any reading.
+  constexpr double kSettled = 1.0e-10;
+  for (int ch = 0; ch < numChannels; ++ch)
+  {
+    const auto& s = state[(size_t) ch];
+    if (std::abs(s.shelf1) > kSettled || std::abs(s.shelf2) > kSettled
+        || std::abs(s.highPass1) > kSettled || std::abs(s.highPass2) > kSettled)
+      return false;
+  }
+  return true;
+}
+
+void LoudnessMeter::finishHop()
+{
+  hops[(size_t) hopIndex] = hopEnergy;
+  hopIndex = (hopIndex + 1) % kHopsPerShortTerm;
+  hopEnergy = 0.0;
+  hopPosition = 0;
+  hopsSinceReset = std::min(hopsSinceReset + 1, kHopsPerShortTerm);
+
+  // Until a window has filled, average over the hops measured so far: the
+  // zeros reset() left in the rest are not audio.
+  const int momentaryHops = std::min(hopsSinceReset, kHopsPerMomentary);
+  double momentary = 0.0;
+  double shortTerm = 0.0;
+  for (int i = 1; i <= hopsSinceReset; ++i)
+  {
+    const double energy = hops[(size_t) ((hopIndex - i + kHopsPerShortTerm) % kHopsPerShortTerm)];
+    shortTerm += energy;
+    if (i <= momentaryHops)
+      momentary += energy;
+  }
+
+  const double momentaryMeanSquare = momentary / (double) (momentaryHops * hopLength);
+  readings.momentary = toReading(energyToLufs(momentaryMeanSquare));
+  readings.shortTerm = toReading(energyToLufs(shortTerm / (double) (hopsSinceReset * hopLength)));
+
+  // Every hop closes one 400 ms gating block (75% overlap), once 4 hops
+  // have been measured; the first 3 would count the zeros from reset() as
+  // audio and pull the integrated reading down. Blocks below the absolute
+  // gate never enter the histogram.
+  const double blockLufs = energyToLufs(momentaryMeanSquare);
+  if (hopsSinceReset >= kHopsPerMomentary && blockLufs > kAbsoluteGateLufs)
+  {
+    const auto bin = (size_t) binFor(blockLufs, kHistogramBins);
+    ++histogramCounts[bin];
+    histogramEnergy[bin] += momentaryMeanSquare;
+    ++gatedBlocks;
+    gatedEnergy += momentaryMeanSquare;
+    updateIntegrated();
+  }
+}
+
+void LoudnessMeter::updateIntegrated()
+{
+  // Relative gate: 10 LU below the mean of all absolute-gated blocks.
+  const double relativeGate = energyToLufs(gatedEnergy / (double) gatedBlocks) + kRelativeGateLu;
+  const int firstBin = relativeGate <= kAbsoluteGateLufs ? 0 : binFor(relativeGate, kHistogramBins);
+
+  // Only the bin holding the gate itself is approximate (+-0.1 LU).
+  double energy = 0.0;
+  uint64_t count = 0;
+  for (int bin = firstBin; bin < kHistogramBins; ++bin)
+  {
+    energy += histogramEnergy[(size_t) bin];
+    count += histogramCounts[(size_t) bin];
+  }
+
+  readings.integrated = count > 0 ? toReading(energyToLufs(energy / (double) count)) : kSilence;
+}
+}
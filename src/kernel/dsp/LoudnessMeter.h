@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MeterFrame.h"
+
+#include <array>
+#include <cstdint>
+
+/**
+  LoudnessMeter
+  -------------
+  ITU-R BS.1770-4 / EBU R128 loudness of the plugin's output: momentary
+  (400 ms), short-term (3 s) and integrated (gated) loudness in LUFS.
+
+  How it works:
+  - Each channel goes through the K-weighting filter (a high shelf + a
+    high-pass, as two biquads). Coefficients are derived for the actual
+    sample rate, so 44.1/48/96 kHz all match the reference response.
+  - The squared, weighted signal is summed into 100 ms "hops". The last 4
+    hops make the momentary window, the last 30 the short-term window, and
+    every new hop yields one overlapping 400 ms gating block (from the 4th
+    hop after reset() on: before that the block would be part silence).
+    Until a window has filled, it is the mean of the hops measured so far,
+    so a steady tone reads its true level from the first hop.
+  - Integrated loudness needs ALL gating blocks since the reset. Instead of
+    storing them, each block above the absolute gate (-70 LUFS) is counted
+    in a fixed histogram of 0.1 LU bins from -70 to +30 LUFS (count and
+    summed energy per bin, ~12 KB in total). The relative gate (-10 LU
+    below the mean) and the gated mean are then computed from the
+    histogram, so memory is fixed and the cost per hop is bounded no matter
+    how long the program runs.
+
+  Real-time: process() does no allocation and takes no locks. Call
+  prepare() from prepareToPlay(); it derives the filter coefficients for
+  the sample rate and resets the state.
+*/
+namespace dsp
+{
+class LoudnessMeter
+{
+public:
+  static constexpr int kMaxChannels = MeterFrame::kMaxChannels;
+
+  void prepare(double sampleRate);
+
+  // BS.1770 weight of a channel's energy: 1.0 (default) for front and
+  // height channels, 1.41 for surrounds, 0 to leave a channel out (LFE).
+  // Call after prepare().
+  void setChannelWeight(int channel, double weight);
+
+  // Clears all windows and the integrated history (audio thread is fine).
+  void reset();
+
+  // Measures numSamples of each channel (float or double; the filters run
+  // in double either way). Returns true when at least one new 100 ms hop
+  // completed, i.e. getReadings() has changed.
+  template <typename Sample>
+  bool process(const Sample* const* channels, int numChannels, int numSamples);
+
+  // Same as process() for a block the caller knows is all zeros. While the
+  // K-weighting filters still ring it runs the filters; after that (a few
+  // hundred ms of silence) it only advances the 100 ms hops.
+  template <typename Sample>
+  bool processSilence(const Sample* const* zeros, int numChannels, int numSamples);
+
+  LoudnessFrame getReadings() const { return readings; }
+
+private:
+  static constexpr int kHopsPerMomentary = 4;   // 400 ms
+  static constexpr int kHopsPerShortTerm = 30;  // 3 s
+  static constexpr int kHistogramBins = 1000;   // -70 .. +30 LUFS, 0.1 LU
+
+  struct Biquad
+  {
+    double b0 { 1.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+  };
+
+  // Transposed direct form II state for the two K-weighting stages.
+  struct ChannelState
+  {
+    double shelf1 { 0.0 }, shelf2 { 0.0 };
+    double highPass1 { 0.0 }, highPass2 { 0.0 };
+  };
+
+  void finishHop();
+  bool filtersSettled(int numChannels) const;
+  void updateIntegrated();
+
+  Biquad shelf;
+  Biquad highPass;
+  std::array<ChannelState, kMaxChannels> state {};
+  // BS.1770 channel weights (1.0 for L/R/C, 1.41 for surrounds).
+  std::array<double, kMaxChannels> channelWeights {};
+
+  int hopLength { 4800 };
+  int hopPosition { 0 };
+  double hopEnergy { 0.0 };
+
+  // Energy (weighted mean square * hop length) of the last 30 hops.
+  std::array<double, kHopsPerShortTerm> hops {};
+  int hopIndex { 0 };
+  int hopsSinceReset { 0 }; // stops counting at kHopsPerShortTerm
+
+  // Integrated loudness: gating blocks per 0.1 LU bin (count + summed mean
+  // square), plus running totals for the relative gate.
+  std::array<uint32_t, kHistogramBins> histogramCounts {};
+  std::array<double, kHistogramBins> histogramEnergy {};
+  uint64_t gatedBlocks { 0 };
+  double gatedEnergy { 0.0 };
+
+  LoudnessFrame readings;
+};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+  MeterFrame
+  ----------
+  What processBlock() reports to the UI for one audio block: per-channel
+  peak, RMS and clip count of the output. Frames are small and trivially
+  copyable so they can travel through a lock-free SPSC ring; the editor
+  drains all frames queued since its last timer tick, so short peaks
+  between UI frames are no longer lost.
+
+  LoudnessFrame carries the LUFS readings the same way, one per 100 ms.
+*/
+namespace dsp
+{
+struct ChannelMeter
+{
+  float peak { 0.0f };  // max |sample|, linear
+  float rms { 0.0f };   // sqrt(mean(sample^2)) over the block, linear
+  uint32_t clips { 0 }; // samples above 0 dBFS
+  float truePeak { 0.0f }; // 4x-oversampled peak, linear (0 when off)
+};
+
+struct MeterFrame
+{
+  // Widest supported bus: 16 covers 7.1.4 (12) and 3rd-order ambisonics.
+  static constexpr int kMaxChannels = 16;
+
+  int numChannels { 0 };
+  int numSamples { 0 };
+  std::array<ChannelMeter, kMaxChannels> channels {};
+};
+
+// Loudness readings in LUFS (see LoudnessMeter). -inf until there is
+// enough signal to measure.
+struct LoudnessFrame
+{
+  float momentary { 0.0f };  // 400 ms window
+  float shortTerm { 0.0f };  // 3 s window
+  float integrated { 0.0f }; // gated, since the last reset
+  float truePeakMax { 0.0f }; // dBTP since the last reset (-inf when off)
+};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "GainKernels.h"
+
+#include <xsimd/xsimd.hpp>
+
+/**
+  SimdKernelSelector
+  ------------------
+  Glue between xsimd's arch dispatch and our kernel table.
+
+  xsimd::dispatch() calls operator()(Arch) with the best architecture from
+  the list that the running CPU supports. Each architecture's version of
+  operator() is compiled in its own file under arch/ with the matching
+  compiler flags, so the rest of the plugin stays at the baseline ISA.
+
+  There is one selector per sample type (float, double); each arch/ file
+  instantiates both.
+
+  CMake defines PROGAIN_SIMD_<ARCH>=1 for every arch/ file it builds.
+*/
+namespace dsp
+{
+template <typename Sample>
+struct SimdKernelSelector
+{
+  template <class Arch>
+  const BasicGainKernels<Sample>* operator()(Arch) const;
+};
+
+#if PROGAIN_SIMD_SSE2
+extern template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::sse2>(xsimd::sse2) const;
+extern template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::sse2>(xsimd::sse2) const;
+#endif
+#if PROGAIN_SIMD_AVX2
+extern template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::avx2>(xsimd::avx2) const;
+extern template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::avx2>(xsimd::avx2) const;
+#endif
+#if PROGAIN_SIMD_AVX512
+extern template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::avx512f>(xsimd::avx512f) const;
+extern template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::avx512f>(xsimd::avx512f) const;
+#endif
+#if PROGAIN_SIMD_NEON
+extern template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::neon64>(xsimd::neon64) const;
+extern template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::neon64>(xsimd::neon64) const;
+#endif
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "SimdKernelSelector.h"
+#include "TruePeakDetector.h"
+
+
+/**
+  SimdKernels
+  -----------
+  The xsimd kernel bodies, templated on the target architecture and the
+  sample type (float, or double for 64-bit hosts; a double batch holds
+  half as many samples).
+
+  Only include this from the files in arch/: each of them is compiled with
+  the instruction-set flags for one architecture and explicitly
+  instantiates SimdKernelSelector<Sample>::operator() for it.
+
+  The loops process `batch::size` samples per step and finish the
+  remainder (numSamples % batch::size) with scalar code, so any block size
+  is valid and no alignment is required.
+
+  Everything here except SimdKernelSelector::operator() sits in an
+  anonymous namespace. An inline function with external linkage (including
+  std::max and std::abs) that is compiled in, say, the AVX-512 file could be
+  the copy the linker keeps for the whole plugin, and it would crash with
+  SIGILL on older CPUs. With internal linkage, each arch/ file keeps its own
+  copy.
+*/
+namespace dsp
+{
+namespace
+{
+// Scalar helpers for the remainder loops, used instead of std::max and
+// std::abs (see above).
+template <typename T>
+T maxOf(T a, T b)
+{
+  return a < b ? b : a;
+}
+
+template <typename T>
+T absOf(T v)
+{
+  return v < T(0) ? -v : v;
+}
+
+template <class Arch, typename Sample>
+struct SimdKernels
+{
+  using Batch = xsimd::batch<Sample, Arch>;
+  static constexpr int kBatchSize = (int) Batch::size;
+
+  // Per-lane meter statistics, folded into a ChannelStats once per call.
+  struct StatsBatch
+  {
+    Batch peak { Sample(0) };
+    Batch sumSquares { Sample(0) };
+    Batch clips { Sample(0) }; // 1 per clipped sample; exact up to 2^24 per lane
+
+    void add(const Batch& v)
+    {
+      const Batch magnitude = xsimd::abs(v);
+      peak = xsimd::max(peak, magnitude);
+      sumSquares = xsimd::fma(v, v, sumSquares);
+      clips += xsimd::select(magnitude > Batch(Sample(1)), Batch(Sample(1)), Batch(Sample(0)));
+    }
+
+    void addTo(ChannelStats& stats) const
+    {
+      stats.peak = maxOf(stats.peak, (float) xsimd::reduce_max(peak));
+      stats.sumSquares += (float) xsimd::reduce_add(sumSquares);
+      stats.clips += (uint32_t) xsimd::reduce_add(clips);
+    }
+  };
+
+  static void addScalar(ChannelStats& stats, Sample v)
+  {
+    const Sample magnitude = absOf(v);
+    stats.peak = maxOf(stats.peak, (float) magnitude);
+    stats.sumSquares += (float) (v * v);
+    stats.clips += magnitude > Sample(1) ? 1u : 0u;
+  }
+
+  static void applyConstant(Sample* data, int numSamples, float gain, ChannelStats& stats)
+  {
+    const Batch g((Sample) gain);
+    StatsBatch lanes;
+
+    const int vectorEnd = numSamples - (numSamples % kBatchSize);
+    int i = 0;
+    for (; i < vectorEnd; i += kBatchSize)
+    {
+      const Batch v = Batch::load_unaligned(data + i) * g;
+      v.store_unaligned(data + i);
+      lanes.add(v);
+    }
+    lanes.addTo(stats);
+
+    for (; i < numSamples; ++i)
+    {
+      data[i] *= (Sample) gain;
+      addScalar(stats, data[i]);
+    }
+  }
+
+  static void applyRamp(Sample* data, int numSamples, const RampSegment& segment,
+                        ChannelStats& stats)
+  {
+    const Sample linearStart = segment.linearStart;
+    const Sample linearStep = segment.linearStep;
+    const Sample expRatio = segment.expRatio;
+
+    // Lane k starts at sample k; every step advances all lanes by
+    // kBatchSize samples.
+    Sample linearLanes[kBatchSize];
+    Sample expLanes[kBatchSize];
+    Sample expGain = segment.expStart;
+    Sample ratioPerStep = 1;
+    for (int k = 0; k < kBatchSize; ++k)
+    {
+      linearLanes[k] = linearStart + (Sample) k * linearStep;
+      expLanes[k] = expGain;
+      expGain *= expRatio;
+      ratioPerStep *= expRatio;
+    }
+
+    Batch linearGain = Batch::load_unaligned(linearLanes);
+    Batch expGains = Batch::load_unaligned(expLanes);
+    const Batch linearIncrement(linearStep * (Sample) kBatchSize);
+    const Batch expIncrement(ratioPerStep);
+    StatsBatch lanes;
+
+    const int vectorEnd = numSamples - (numSamples % kBatchSize);
+    int i = 0;
+    for (; i < vectorEnd; i += kBatchSize)
+    {
+      const Batch v = Batch::load_unaligned(data + i) * (linearGain * expGains);
+      v.store_unaligned(data + i);
+      lanes.add(v);
+      linearGain += linearIncrement;
+      expGains *= expIncrement;
+    }
+
+    // Lane 0 now holds the exponential gain for sample i.
+    expGains.store_unaligned(expLanes);
+    expGain = expLanes[0];
+    lanes.addTo(stats);
+
+    for (; i < numSamples; ++i)
+    {
+      const Sample linear = linearStart + (Sample) i * linearStep;
+      data[i] *= linear * expGain;
+      addScalar(stats, data[i]);
+      expGain *= expRatio;
+    }
+  }
+
+  static void measure(const Sample* data, int numSamples, ChannelStats& stats)
+  {
+    StatsBatch lanes;
+
+    const int vectorEnd = numSamples - (numSamples % kBatchSize);
+    int i = 0;
+    for (; i < vectorEnd; i += kBatchSize)
+      lanes.add(Batch::load_unaligned(data + i));
+    lanes.addTo(stats);
+
+    for (; i < numSamples; ++i)
+      addScalar(stats, data[i]);
+  }
+
+  static bool isSilent(const Sample* data, int numSamples)
+  {
+    // Two batches per test: one branch per 2 * kBatchSize samples, and
+    // audio that isn't silent fails on the first one.
+    const Batch zero(Sample(0));
+    const int pairEnd = numSamples - (numSamples % (2 * kBatchSize));
+    int i = 0;
+    for (; i < pairEnd; i += 2 * kBatchSize)
+    {
+      const auto nonZero = (Batch::load_unaligned(data + i) != zero)
+                         | (Batch::load_unaligned(data + i + kBatchSize) != zero);
+      if (xsimd::any(nonZero))
+        return false;
+    }
+
+    for (; i < numSamples; ++i)
+      if (data[i] != Sample(0))
+        return false;
+    return true;
+  }
+
+  static float truePeak(const Sample* samples, int numSamples)
+  {
+    using Filter = TruePeakFilter;
+
+    // Each lane is one input position; all four phases are built from the
+    // same 12 shifted loads.
+    Batch peak(Sample(0));
+    const int vectorEnd = numSamples - (numSamples % kBatchSize);
+    int i = 0;
+    for (; i < vectorEnd; i += kBatchSize)
+    {
+      Batch y0(Sample(0)), y1(Sample(0)), y2(Sample(0)), y3(Sample(0));
+      for (int k = 0; k < Filter::kTapsPerPhase; ++k)
+      {
+        const Batch x = Batch::load_unaligned(samples + i - k);
+        y0 = xsimd::fma(Batch((Sample) Filter::kCoefficients[0][k]), x, y0);
+        y1 = xsimd::fma(Batch((Sample) Filter::kCoefficients[1][k]), x, y1);
+        y2 = xsimd::fma(Batch((Sample) Filter::kCoefficients[2][k]), x, y2);
+        y3 = xsimd::fma(Batch((Sample) Filter::kCoefficients[3][k]), x, y3);
+      }
+      peak = xsimd::max(peak, xsimd::max(xsimd::max(xsimd::abs(y0), xsimd::abs(y1)),
+                                         xsimd::max(xsimd::abs(y2), xsimd::abs(y3))));
+    }
+
+    Sample tailPeak = 0;
+    for (; i < numSamples; ++i)
+    {
+      for (int phase = 0; phase < Filter::kPhases; ++phase)
+      {
+        Sample y = 0;
+        for (int k = 0; k < Filter::kTapsPerPhase; ++k)
+          y += (Sample) Filter::kCoefficients[phase][k] * samples[i - k];
+        tailPeak = maxOf(tailPeak, absOf(y));
+      }
+    }
+    return (float) maxOf(xsimd::reduce_max(peak), tailPeak);
+  }
+};
+}
+
+template <typename Sample>
+template <class Arch>
+const BasicGainKernels<Sample>* SimdKernelSelector<Sample>::operator()(Arch) const
+{
+  using Kernels = SimdKernels<Arch, Sample>;
+  static const BasicGainKernels<Sample> table {
+    Arch::name(),
+    &Kernels::applyConstant,
+    &Kernels::applyRamp,
+    &Kernels::measure,
+    &Kernels::isSilent,
+    &Kernels::truePeak
+  };
+  return &table;
+}
+}
@@ -0,0 +1,67 @@
+/**
+  TruePeakDetector.cpp
+  --------------------
+  History handling around the polyphase true-peak kernel.
+*/
+#include "TruePeakDetector.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace dsp
+{
+void TruePeakDetector::reset()
+{
+  for (auto& channel : history)
+    channel.fill(0.0);
+}
+
+template <typename Sample>
+Sample* TruePeakDetector::scratchFor()
+{
+  if constexpr (std::is_same_v<Sample, double>)
+    return scratch64.data();
+  else
+    return scratch.data();
+}
+
+template <typename Sample>
+float TruePeakDetector::process(int channel, const Sample* data, int numSamples,
+                                const BasicGainKernels<Sample>& kernels)
+{
+  auto& past = history[(size_t) channel];
+  Sample* const buffer = scratchFor<Sample>();
+  float peak = 0.0f;
+
+  // scratch = [last 11 samples | next chunk]; the kernel reads back into
+  // the history part for the first outputs of the chunk.
+  for (int done = 0; done < numSamples;)
+  {
+    const int count = std::min(kChunk, numSamples - done);
+    std::copy(past.begin(), past.end(), buffer);
+    std::copy(data + done, data + done + count, buffer + kHistory);
+
+    peak = std::max(peak, kernels.truePeak(buffer + kHistory, count));
+
+    std::copy(buffer + count, buffer + count + kHistory, past.begin());
+    done += count;
+  }
+  return peak;
+}
+
+template <typename Sample>
+float TruePeakDetector::processSilence(int channel, const Sample* zeros, int numSamples,
+                                       const BasicGainKernels<Sample>& kernels)
+{
+  // The tail of the previous block still rings through the FIR.
+  const auto& past = history[(size_t) channel];
+  if (std::any_of(past.begin(), past.end(), [](double x) { return x != 0.0; }))
+    return process(channel, zeros, numSamples, kernels);
+  return 0.0f;
+}
+
+template float TruePeakDetector::process(int, const float*, int, const GainKernels&);
+template float TruePeakDetector::process(int, const double*, int, const GainKernels64&);
+template float TruePeakDetector::processSilence(int, const float*, int, const GainKernels&);
+template float TruePeakDetector::processSilence(int, const double*, int, const GainKernels64&);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "GainKernels.h"
+#include "MeterFrame.h"
+
+#include <array>
+
+/**
+  TruePeakDetector
+  ----------------
+  True-peak (dBTP) detection per ITU-R BS.1770-4 Annex 2: the signal is
+  upsampled 4x with a 48-tap polyphase FIR and the peak of the upsampled
+  signal is taken. Sample peaks miss "inter-sample overs" that appear after
+  D/A conversion or lossy encoding; this catches them to within ~0.5 dB.
+
+  The filter is applied as four 12-tap phases (one per output position
+  between input samples). The inner loop lives in the kernel table
+  (GainKernels::truePeak) so it is vectorized across input samples like the
+  gain kernels and picked per CPU at prepareToPlay().
+
+  This class only keeps the last 11 input samples of each channel (the FIR
+  history) and feeds the kernel in fixed-size chunks from a member scratch
+  buffer (one per sample type), so process() never allocates.
+*/
+namespace dsp
+{
+struct TruePeakFilter
+{
+  static constexpr int kPhases = 4;
+  static constexpr int kTapsPerPhase = 12;
+
+  // BS.1770-4 Annex 2, Table 1, split into phases.
+  static constexpr float kCoefficients[kPhases][kTapsPerPhase] = {
+    { 0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f,
+      -0.0594482421875f, 0.1373291015625f, 0.9721679687500f, -0.1022949218750f,
+      0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f,
+      -0.1665039062500f, 0.4650878906250f, 0.7797851562500f, -0.2003173828125f,
+      0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f,
+      -0.2003173828125f, 0.7797851562500f, 0.4650878906250f, -0.1665039062500f,
+      0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f,
+      -0.1022949218750f, 0.9721679687500f, 0.1373291015625f, -0.0594482421875f,
+      0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f }
+  };
+};
+
+class TruePeakDetector
+{
+public:
+  static constexpr int kMaxChannels = MeterFrame::kMaxChannels;
+
+  // Clears the FIR history (call when (re)starting detection).
+  void reset();
+
+  // Returns the true peak (linear, max |x| at 4x) of numSamples samples of
+  // `channel`, continuing from that channel's previous call. Sample is
+  // float or double (the history carries over between the two).
+  template <typename Sample>
+  float process(int channel, const Sample* data, int numSamples, const BasicGainKernels<Sample>& kernels);
+
+  // Same as process() for a block the caller knows is all zeros: once the
+  // history has flushed to zero the peak is 0 and nothing needs computing.
+  template <typename Sample>
+  float processSilence(int channel, const Sample* zeros, int numSamples,
+                       const BasicGainKernels<Sample>& kernels);
+
+private:
+  static constexpr int kHistory = TruePeakFilter::kTapsPerPhase - 1;
+  static constexpr int kChunk = 256;
+
+  template <typename Sample>
+  Sample* scratchFor();
+
+  // Kept in double so either sample type round-trips through it exactly.
+  std::array<std::array<double, kHistory>, kMaxChannels> history {};
+  std::array<float, kHistory + kChunk> scratch {};
+  std::array<double, kHistory + kChunk> scratch64 {};
+};
+}
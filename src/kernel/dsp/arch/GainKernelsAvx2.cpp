@@ -0,0 +1,13 @@
+/**
+  GainKernelsAvx2.cpp
+  -------------------
+  AVX2 instantiation of the SIMD kernels (float and double).
+  CMake compiles this file with the matching instruction-set flags.
+*/
+#include "../SimdKernels.h"
+
+namespace dsp
+{
+template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::avx2>(xsimd::avx2) const;
+template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::avx2>(xsimd::avx2) const;
+}
@@ -0,0 +1,13 @@
+/**
+  GainKernelsAvx512.cpp
+  ---------------------
+  AVX-512F instantiation of the SIMD kernels (float and double).
+  CMake compiles this file with the matching instruction-set flags.
+*/
+#include "../SimdKernels.h"
+
+namespace dsp
+{
+template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::avx512f>(xsimd::avx512f) const;
+template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::avx512f>(xsimd::avx512f) const;
+}
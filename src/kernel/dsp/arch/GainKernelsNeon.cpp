@@ -0,0 +1,13 @@
+/**
+  GainKernelsNeon.cpp
+  -------------------
+  NEON (AArch64) instantiation of the SIMD kernels (float and double).
+  CMake compiles this file with the matching instruction-set flags.
+*/
+#include "../SimdKernels.h"
+
+namespace dsp
+{
+template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::neon64>(xsimd::neon64) const;
+template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::neon64>(xsimd::neon64) const;
+}
@@ -0,0 +1,13 @@
+/**
+  GainKernelsSse2.cpp
+  -------------------
+  SSE2 instantiation of the SIMD kernels (float and double).
+  CMake compiles this file with the matching instruction-set flags.
+*/
+#include "../SimdKernels.h"
+
+namespace dsp
+{
+template const GainKernels* SimdKernelSelector<float>::operator()<xsimd::sse2>(xsimd::sse2) const;
+template const GainKernels64* SimdKernelSelector<double>::operator()<xsimd::sse2>(xsimd::sse2) const;
+}
@@ -0,0 +1,1015 @@
+/**
+  OfflineBench.cpp
+  ----------------
+  Headless offline renderer + CPU benchmark for ProGainAudioProcessor.
+
+  It builds the processor exactly as a host would (bus layout,
+  prepareToPlay, processBlock) but with no DAW and no editor, then sweeps:
+  - block sizes, sample rates
+  - channel layouts: mono, stereo, 5.1, 7.1.4 and 3rd-order ambisonics
+    (1, 2, 6, 12, 16 channels: the counts with specialised gain loops),
+    plus 4th-order ambisonics (25 channels, wider than the meters)
+  - automation patterns (static, ramp, jumps, lfo) plus the fast paths:
+    unity (gain 1.0, trim 0 dB), silence (all-zero input at 0.8x gain) and
+    bypass (a fade to pass-through, then meter scan only)
+  - SIMD vs scalar reference kernels
+  - float vs double buffers (the host's processing precision)
+  - true-peak metering off vs on (what the 4x detector costs)
+
+  For every combination it reports ns/sample, block-time percentiles and
+  the real-time factor (audio seconds rendered per CPU second) as CSV or
+  JSON, so CI can track the per-commit CPU cost of the audio path.
+
+  Usage:
+    ProGainBench [--quick] [--format csv|json] [--out results.csv]
+                 [--input in.wav] [--seconds 10] [--kernels simd|reference|both]
+                 [--true-peak off|on|both] [--precision float|double|both]
+                 [--render out.wav]
+    ProGainBench [--check-loudness] [--check-smoother] [--check-kernels]
+                 [--check-rt-safety]
+
+  --render writes the processed audio of the first configuration to a WAV
+  file, for deterministic listening/diff checks.
+
+  --check-loudness skips the benchmark. It runs the EBU Tech 3341 reference
+  signals through the loudness meter at 44.1/48/96 kHz and exits non-zero
+  if any integrated, momentary or short-term reading is off by more than
+  0.05 LU.
+
+  --check-smoother also skips the benchmark. It renders random automation
+  over the full gain/trim range through GainSmoother and the scalar ramp
+  kernel, compares each sample with an exact double-precision ramp and
+  exits non-zero if the error exceeds the bound GainSmoother.h states.
+
+  --check-kernels also skips the benchmark. It renders every automation
+  case through scalarKernels() and each SIMD variant compiled in that the
+  CPU can run (float and double: applyConstant/applyRamp, measure,
+  isSilent, truePeak) and exits non-zero if any of them differs from the
+  scalar result by more than the stated tolerances.
+
+  --check-rt-safety (a -DPROGAIN_RT_SAFETY=ON build) allocates and locks a
+  mutex on purpose, inside and outside an audio-thread scope, and exits
+  non-zero unless exactly the ones inside are reported. In such a build the
+  benchmark itself also fails on any violation inside processBlock().
+
+  The checks can be combined.
+*/
+#include <JuceHeader.h>
+
+#include "PluginProcessor.h"
+#include "infra/diagnostics/RealtimeSafety.h"
+#include "infra/parameters/ParameterRegistry.h"
+#include "kernel/dsp/GainKernels.h"
+#include "kernel/dsp/GainSmoother.h"
+#include "kernel/dsp/LoudnessMeter.h"
+#include "kernel/dsp/TruePeakDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+enum class Automation
+{
+  staticGain,
+  ramp,
+  jumps,
+  lfo,
+  unity,
+  silence,
+  bypass
+};
+
+const char* toString(Automation automation)
+{
+  switch (automation)
+  {
+    case Automation::staticGain: return "static";
+    case Automation::ramp: return "ramp";
+    case Automation::jumps: return "jumps";
+    case Automation::lfo: return "lfo";
+    case Automation::unity: return "unity";
+    case Automation::silence: return "silence";
+    case Automation::bypass: return "bypass";
+  }
+  return "unknown";
+}
+
+struct Options
+{
+  bool quick { false };
+  std::string format { "csv" };
+  std::string outPath;
+  std::string inputPath;
+  std::string renderPath;
+  std::string kernels { "both" };
+  std::string truePeak { "both" };
+  std::string precision { "float" };
+  double seconds { 10.0 };
+  bool checkLoudness { false };
+  bool checkSmoother { false };
+  bool checkKernels { false };
+  bool checkRealtimeSafety { false };
+};
+
+struct Config
+{
+  bool reference;
+  bool truePeak;
+  bool doublePrecision;
+  double sampleRate;
+  int channels;
+  int blockSize;
+  Automation automation;
+};
+
+struct Result
+{
+  Config config;
+  int blocks { 0 };
+  double nsPerSample { 0.0 };        // per sample frame (all channels)
+  double nsPerChannelSample { 0.0 }; // nsPerSample / channels
+  double p50Us { 0.0 };
+  double p90Us { 0.0 };
+  double p99Us { 0.0 };
+  double maxUs { 0.0 };
+  double realtimeFactor { 0.0 };
+};
+
+bool parseArgs(int argc, char* argv[], Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    auto next = [&](std::string& out) {
+      if (i + 1 >= argc)
+        return false;
+      out = argv[++i];
+      return true;
+    };
+
+    std::string value;
+    if (arg == "--quick")
+      options.quick = true;
+    else if (arg == "--check-loudness")
+      options.checkLoudness = true;
+    else if (arg == "--check-smoother")
+      options.checkSmoother = true;
+    else if (arg == "--check-kernels")
+      options.checkKernels = true;
+    else if (arg == "--check-rt-safety")
+      options.checkRealtimeSafety = true;
+    else if (arg == "--format" && next(value))
+      options.format = value;
+    else if (arg == "--out" && next(value))
+      options.outPath = value;
+    else if (arg == "--input" && next(value))
+      options.inputPath = value;
+    else if (arg == "--render" && next(value))
+      options.renderPath = value;
+    else if (arg == "--kernels" && next(value))
+      options.kernels = value;
+    else if (arg == "--true-peak" && next(value))
+      options.truePeak = value;
+    else if (arg == "--precision" && next(value))
+      options.precision = value;
+    else if (arg == "--seconds" && next(value))
+      options.seconds = std::max(0.1, std::atof(value.c_str()));
+    else
+    {
+      std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+      return false;
+    }
+  }
+
+  return (options.format == "csv" || options.format == "json")
+      && (options.kernels == "simd" || options.kernels == "reference" || options.kernels == "both")
+      && (options.truePeak == "off" || options.truePeak == "on" || options.truePeak == "both")
+      && (options.precision == "float" || options.precision == "double" || options.precision == "both");
+}
+
+// Test signal: a sine plus noise around -12 dBFS, or the user's WAV file.
+juce::AudioBuffer<float> makeSource(const Options& options)
+{
+  if (!options.inputPath.empty())
+  {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(
+      formats.createReaderFor(juce::File::getCurrentWorkingDirectory().getChildFile(options.inputPath)));
+    if (reader != nullptr && reader->lengthInSamples > 0)
+    {
+      juce::AudioBuffer<float> source((int) reader->numChannels, (int) reader->lengthInSamples);
+      reader->read(&source, 0, source.getNumSamples(), 0, true, true);
+      return source;
+    }
+    std::cerr << "Could not read " << options.inputPath << ", using synthetic input.\n";
+  }
+
+  constexpr int kChannels = 2;
+  constexpr int kLength = 1 << 16;
+  juce::AudioBuffer<float> source(kChannels, kLength);
+  juce::Random random(1234);
+  for (int ch = 0; ch < kChannels; ++ch)
+  {
+    auto* data = source.getWritePointer(ch);
+    for (int i = 0; i < kLength; ++i)
+    {
+      const float sine = std::sin(juce::MathConstants<float>::twoPi * 220.0f * (float) i / 48000.0f);
+      data[i] = 0.125f * sine + 0.125f * (random.nextFloat() * 2.0f - 1.0f);
+    }
+  }
+  return source;
+}
+
+void setParameter(ProGainAudioProcessor& processor, const char* id, float value)
+{
+  if (auto* param = processor.getAPVTS().getParameter(id))
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+// Parameter values an automation pattern asks for. Every run starts at
+// gain 0.8x, trim -3 dB.
+struct AutomationTargets
+{
+  float gain { 0.8f };
+  float trimDb { -3.0f };
+  bool bypass { false };
+};
+
+struct AutomationState
+{
+  juce::Random random { 42 };
+  long long lastJump { -1 };
+  AutomationTargets targets;
+};
+
+// Parameter targets for the block starting at `seconds`.
+const AutomationTargets& updateAutomation(Automation automation, double seconds, AutomationState& state)
+{
+  auto& targets = state.targets;
+  switch (automation)
+  {
+    case Automation::staticGain:
+    case Automation::silence:
+      break;
+    case Automation::bypass:
+      targets.bypass = true;
+      break;
+    case Automation::unity:
+      targets.gain = 1.0f;
+      targets.trimDb = 0.0f;
+      break;
+    case Automation::ramp:
+    {
+      // 4 s triangle sweep: the smoother never settles.
+      const double phase = std::fmod(seconds / 4.0, 1.0);
+      const double triangle = phase < 0.5 ? phase * 2.0 : 2.0 - phase * 2.0;
+      targets.gain = (float) (0.25 + 1.5 * triangle);
+      break;
+    }
+    case Automation::jumps:
+    {
+      // A new random target every 250 ms: short ramps, then settled.
+      const auto jump = (long long) (seconds / 0.25);
+      if (jump != state.lastJump)
+      {
+        state.lastJump = jump;
+        targets.gain = state.random.nextFloat() * 2.0f;
+        targets.trimDb = state.random.nextFloat() * 24.0f - 12.0f;
+      }
+      break;
+    }
+    case Automation::lfo:
+      targets.trimDb = (float) (6.0 * std::sin(juce::MathConstants<double>::twoPi * 0.5 * seconds));
+      break;
+  }
+  return targets;
+}
+
+void applyAutomation(ProGainAudioProcessor& processor, Automation automation, double seconds, AutomationState& state)
+{
+  const auto& targets = updateAutomation(automation, seconds, state);
+  setParameter(processor, "gain", targets.gain);
+  setParameter(processor, "trim", targets.trimDb);
+  setParameter(processor, "bypass", targets.bypass ? 1.0f : 0.0f);
+}
+
+// The layout a session would use for that many channels.
+juce::AudioChannelSet layoutFor(int channels)
+{
+  switch (channels)
+  {
+    case 12: return juce::AudioChannelSet::create7point1point4();
+    case 16: return juce::AudioChannelSet::ambisonic(3);
+    case 25: return juce::AudioChannelSet::ambisonic(4);
+    default: return juce::AudioChannelSet::canonicalChannelSet(channels);
+  }
+}
+
+double percentile(std::vector<double>& sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.0;
+  const auto index = (size_t) std::min((double) sorted.size() - 1.0, fraction * (double) (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+Result runConfig(const Config& config,
+                 const Options& options,
+                 const juce::AudioBuffer<float>& source,
+                 juce::AudioBuffer<float>* renderOut)
+{
+  Result result;
+  result.config = config;
+
+  ProGainAudioProcessor processor;
+  processor.setUseReferenceKernels(config.reference);
+
+  juce::AudioProcessor::BusesLayout layout;
+  layout.inputBuses.add(layoutFor(config.channels));
+  layout.outputBuses.add(layoutFor(config.channels));
+  if (!processor.setBusesLayout(layout))
+    return result;
+
+  const AutomationTargets initial;
+  setParameter(processor, "gain", initial.gain);
+  setParameter(processor, "trim", initial.trimDb);
+  setParameter(processor, "truePeak", config.truePeak ? 1.0f : 0.0f);
+
+  processor.setProcessingPrecision(config.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                          : juce::AudioProcessor::singlePrecision);
+  processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+  processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+  const int totalSamples = (int) (options.seconds * config.sampleRate);
+  const int numBlocks = totalSamples / config.blockSize;
+  if (renderOut != nullptr)
+    renderOut->setSize(config.channels, numBlocks * config.blockSize);
+
+  juce::AudioBuffer<float> buffer(config.channels, config.blockSize);
+  juce::AudioBuffer<double> buffer64(config.channels, config.blockSize);
+  juce::MidiBuffer midi;
+  AutomationState automationState;
+  std::vector<double> blockNs;
+  blockNs.reserve((size_t) numBlocks);
+
+  double totalNs = 0.0;
+  int sourcePos = 0;
+
+  for (int block = 0; block < numBlocks; ++block)
+  {
+    // Fill the block from the looping source (not timed).
+    for (int ch = 0; ch < config.channels; ++ch)
+    {
+      const auto* src = source.getReadPointer(ch % source.getNumChannels());
+      auto* dst = buffer.getWritePointer(ch);
+      for (int i = 0; i < config.blockSize; ++i)
+        dst[i] = config.automation == Automation::silence ? 0.0f : src[(sourcePos + i) % source.getNumSamples()];
+    }
+    sourcePos = (sourcePos + config.blockSize) % source.getNumSamples();
+    if (config.doublePrecision)
+      buffer64.makeCopyOf(buffer, true);
+
+    applyAutomation(processor, config.automation, (double) block * config.blockSize / config.sampleRate, automationState);
+
+    const auto start = std::chrono::steady_clock::now();
+    if (config.doublePrecision)
+      processor.processBlock(buffer64, midi);
+    else
+      processor.processBlock(buffer, midi);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    blockNs.push_back(ns);
+    totalNs += ns;
+
+    if (renderOut != nullptr)
+    {
+      if (config.doublePrecision)
+        buffer.makeCopyOf(buffer64, true);
+      for (int ch = 0; ch < config.channels; ++ch)
+        renderOut->copyFrom(ch, block * config.blockSize, buffer, ch, 0, config.blockSize);
+    }
+  }
+
+  processor.releaseResources();
+
+  std::sort(blockNs.begin(), blockNs.end());
+  result.blocks = numBlocks;
+  result.nsPerSample = numBlocks > 0 ? totalNs / ((double) numBlocks * config.blockSize) : 0.0;
+  result.nsPerChannelSample = result.nsPerSample / config.channels;
+  result.p50Us = percentile(blockNs, 0.50) / 1000.0;
+  result.p90Us = percentile(blockNs, 0.90) / 1000.0;
+  result.p99Us = percentile(blockNs, 0.99) / 1000.0;
+  result.maxUs = blockNs.empty() ? 0.0 : blockNs.back() / 1000.0;
+  const double audioSeconds = (double) numBlocks * config.blockSize / config.sampleRate;
+  result.realtimeFactor = totalNs > 0.0 ? audioSeconds / (totalNs * 1e-9) : 0.0;
+  return result;
+}
+
+std::string formatCsv(const std::vector<Result>& results)
+{
+  std::ostringstream out;
+  out << "kernels,true_peak,precision,sample_rate,channels,block_size,automation,blocks,ns_per_sample,"
+         "ns_per_channel_sample,p50_us,p90_us,p99_us,max_us,realtime_factor\n";
+  for (const auto& r : results)
+  {
+    out << (r.config.reference ? "reference" : "simd") << ','
+        << (r.config.truePeak ? "on" : "off") << ','
+        << (r.config.doublePrecision ? "double" : "float") << ','
+        << r.config.sampleRate << ',' << r.config.channels << ',' << r.config.blockSize << ','
+        << toString(r.config.automation) << ',' << r.blocks << ','
+        << r.nsPerSample << ',' << r.nsPerChannelSample << ',' << r.p50Us << ',' << r.p90Us << ',' << r.p99Us << ','
+        << r.maxUs << ',' << r.realtimeFactor << '\n';
+  }
+  return out.str();
+}
+
+std::string formatJson(const std::vector<Result>& results, const juce::String& kernelInfo)
+{
+  std::ostringstream out;
+  out << "{\n  \"kernelInfo\": " << juce::JSON::toString(kernelInfo).toStdString() << ",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& r = results[i];
+    out << "    {\"kernels\": \"" << (r.config.reference ? "reference" : "simd") << "\""
+        << ", \"truePeak\": " << (r.config.truePeak ? "true" : "false")
+        << ", \"precision\": \"" << (r.config.doublePrecision ? "double" : "float") << "\""
+        << ", \"sampleRate\": " << r.config.sampleRate
+        << ", \"channels\": " << r.config.channels
+        << ", \"blockSize\": " << r.config.blockSize
+        << ", \"automation\": \"" << toString(r.config.automation) << "\""
+        << ", \"blocks\": " << r.blocks
+        << ", \"nsPerSample\": " << r.nsPerSample
+        << ", \"nsPerChannelSample\": " << r.nsPerChannelSample
+        << ", \"p50Us\": " << r.p50Us
+        << ", \"p90Us\": " << r.p90Us
+        << ", \"p99Us\": " << r.p99Us
+        << ", \"maxUs\": " << r.maxUs
+        << ", \"realtimeFactor\": " << r.realtimeFactor << "}"
+        << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  return out.str();
+}
+
+bool writeWav(const std::string& path, const juce::AudioBuffer<float>& audio, double sampleRate)
+{
+  const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+  file.deleteFile();
+
+  auto stream = std::make_unique<juce::FileOutputStream>(file);
+  if (!stream->openedOk())
+    return false;
+
+  juce::WavAudioFormat wav;
+  std::unique_ptr<juce::AudioFormatWriter> writer(
+    wav.createWriterFor(stream.get(), sampleRate, (unsigned int) audio.getNumChannels(), 24, {}, 0));
+  if (writer == nullptr)
+    return false;
+
+  stream.release(); // the writer owns it now
+  return writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples());
+}
+
+// EBU Tech 3341 reference signals: a 1 kHz sine in both stereo channels,
+// as (seconds, dBFS) segments, and the integrated loudness it must read.
+struct LoudnessCase
+{
+  const char* name;
+  std::vector<std::pair<double, double>> segments;
+  double expectedLufs;
+};
+
+// Runs the reference cases through dsp::LoudnessMeter at 44.1, 48 and
+// 96 kHz. True if every integrated reading is within 0.05 LU, and the
+// momentary and short-term readings at the end are within 0.05 LU of the
+// last segment's level (each case ends on a steady tone, and the short one
+// checks the windows before they have filled).
+bool checkLoudnessReferences()
+{
+  constexpr double kToleranceLu = 0.05;
+  constexpr int kBlockSize = 512;
+  const std::vector<LoudnessCase> cases {
+    { "3341-1 sine -23 dBFS", { { 20.0, -23.0 } }, -23.0 },
+    { "3341-2 sine -33 dBFS", { { 20.0, -33.0 } }, -33.0 },
+    { "3341-3 relative gate", { { 10.0, -36.0 }, { 60.0, -23.0 }, { 10.0, -36.0 } }, -23.0 },
+    { "3341-4 absolute gate",
+      { { 10.0, -72.0 }, { 10.0, -36.0 }, { 60.0, -23.0 }, { 10.0, -36.0 }, { 10.0, -72.0 } }, -23.0 },
+    { "3341-5 level steps", { { 20.0, -26.0 }, { 20.1, -20.0 }, { 20.0, -26.0 } }, -23.0 },
+    // Short program: blocks overlapping the start must not count silence.
+    { "1 s sine -23 dBFS", { { 1.0, -23.0 } }, -23.0 }
+  };
+
+  bool allPassed = true;
+  for (double sampleRate : { 44100.0, 48000.0, 96000.0 })
+  {
+    for (const auto& test : cases)
+    {
+      dsp::LoudnessMeter meter;
+      meter.prepare(sampleRate);
+
+      std::vector<float> left(kBlockSize), right(kBlockSize);
+      const float* channels[] = { left.data(), right.data() };
+      const double phaseStep = 2.0 * 3.14159265358979323846 * 1000.0 / sampleRate;
+      int64_t sample = 0;
+      for (const auto& [seconds, dbfs] : test.segments)
+      {
+        const double amplitude = std::pow(10.0, dbfs / 20.0);
+        int remaining = (int) std::lround(seconds * sampleRate);
+        while (remaining > 0)
+        {
+          const int count = std::min(remaining, kBlockSize);
+          for (int i = 0; i < count; ++i, ++sample)
+            left[(size_t) i] = right[(size_t) i] = (float) (amplitude * std::sin(phaseStep * (double) sample));
+          meter.process(channels, 2, count);
+          remaining -= count;
+        }
+      }
+
+      const auto readings = meter.getReadings();
+      const double lastLevel = test.segments.back().second;
+      const bool passed = std::abs(readings.integrated - test.expectedLufs) <= kToleranceLu
+                          && std::abs(readings.momentary - lastLevel) <= kToleranceLu
+                          && std::abs(readings.shortTerm - lastLevel) <= kToleranceLu;
+      allPassed = allPassed && passed;
+
+      char line[200];
+      std::snprintf(line, sizeof(line), "%-22s %6.0f Hz  I %7.2f (expected %.1f)  M %7.2f  S %7.2f (expected %.1f)  %s\n",
+                    test.name, sampleRate, readings.integrated, test.expectedLufs, readings.momentary,
+                    readings.shortTerm, lastLevel, passed ? "ok" : "FAIL");
+      std::cout << line;
+    }
+  }
+  return allPassed;
+}
+
+// GainSmoother + scalar ramp kernel against an exact double-precision model
+// of the same ramps (linear in gain and in dB, SmoothedValue semantics:
+// retargeting starts from the current value). Random automation over the
+// full gain and trim ranges. Returns the max |error| of the output for input in [-1, 1].
+template <typename Sample>
+double measureSmootherError(float rampSeconds)
+{
+  constexpr double kSampleRate = 48000.0;
+  constexpr int kBlocks = 20000;
+  constexpr int kMaxBlockSize = 1024;
+
+  struct ExactRamp
+  {
+    double current { 1.0 }, target { 1.0 }, step { 0.0 };
+    int countdown { 0 };
+
+    void setTarget(double value, int steps)
+    {
+      if (value == target)
+        return;
+      target = value;
+      countdown = steps;
+      step = (target - current) / steps;
+    }
+
+    double next()
+    {
+      if (countdown > 0 && --countdown == 0)
+        current = target;
+      else if (countdown > 0)
+        current += step;
+      return current;
+    }
+  };
+
+  const auto& gainSpec = params::kGain.spec();
+  const auto& trimSpec = params::kTrim.spec();
+  const int steps = (int) std::floor(kSampleRate * (double) rampSeconds);
+
+  dsp::GainSmoother smoother;
+  smoother.reset(kSampleRate, rampSeconds, rampSeconds);
+  smoother.setCurrentAndTargetValue(1.0f, 0.0f);
+  ExactRamp gain, trimDb;
+  trimDb.current = trimDb.target = 0.0;
+
+  const auto& kernels = dsp::scalarKernels<Sample>();
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<Sample> input((size_t) kMaxBlockSize), output((size_t) kMaxBlockSize);
+  double maxError = 0.0;
+
+  for (int block = 0; block < kBlocks; ++block)
+  {
+    const int numSamples = 1 + (int) (unit(random) * (kMaxBlockSize - 1));
+    if (unit(random) < 0.3f)
+    {
+      const float newGain = gainSpec.min + unit(random) * (gainSpec.max - gainSpec.min);
+      const float newTrim = trimSpec.min + unit(random) * (trimSpec.max - trimSpec.min);
+      smoother.setTargetValue(newGain, newTrim);
+      gain.setTarget(newGain, steps);
+      trimDb.setTarget(newTrim, steps);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+      output[(size_t) i] = input[(size_t) i] = (Sample) (unit(random) * 2.0f - 1.0f);
+
+    // Same split as the processor: segments while moving, then a constant.
+    dsp::ChannelStats stats;
+    int done = 0;
+    while (done < numSamples && smoother.isSmoothing())
+    {
+      dsp::RampSegment segment;
+      const int length = smoother.nextSegment(numSamples - done, segment);
+      kernels.applyRamp(output.data() + done, length, segment, stats);
+      done += length;
+    }
+    if (done < numSamples)
+      kernels.applyConstant(output.data() + done, numSamples - done, smoother.getTargetGain(), stats);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+      const double exact = (double) input[(size_t) i] * gain.next() * std::pow(10.0, trimDb.next() / 20.0);
+      maxError = std::max(maxError, std::abs((double) output[(size_t) i] - exact));
+    }
+  }
+  return maxError;
+}
+
+// The bound GainSmoother.h states, for the default smoothing time and for
+// long (1 s, 5 s) ramps, float and double buffers.
+bool checkSmootherAccuracy()
+{
+  constexpr double kMaxError = 4.0e-5;
+
+  bool allPassed = true;
+  for (float rampSeconds : { params::kGain.spec().smoothingSeconds, 1.0f, 5.0f })
+  {
+    for (bool doublePrecision : { false, true })
+    {
+      const double error = doublePrecision ? measureSmootherError<double>(rampSeconds)
+                                           : measureSmootherError<float>(rampSeconds);
+      const bool passed = error <= kMaxError;
+      allPassed = allPassed && passed;
+
+      char line[120];
+      std::snprintf(line, sizeof(line), "ramp %5.2f s  %-6s  max error %.2e (bound %.0e)  %s\n", rampSeconds,
+                    doublePrecision ? "double" : "float", error, kMaxError, passed ? "ok" : "FAIL");
+      std::cout << line;
+    }
+  }
+  return allPassed;
+}
+
+// Largest differences between one SIMD kernel table and scalarKernels().
+struct KernelDiff
+{
+  double samples { 0.0 };  // output samples (applyConstant / applyRamp)
+  double peak { 0.0 };     // ChannelStats::peak, from the gain kernels and measure()
+  double energy { 0.0 };   // ChannelStats::sumSquares, relative
+  double truePeak { 0.0 };
+  bool exactMismatch { false }; // isSilent() or clip counts differ
+};
+
+void compareStats(const dsp::ChannelStats& reference, const dsp::ChannelStats& stats, KernelDiff& diff)
+{
+  diff.peak = std::max(diff.peak, (double) std::abs(stats.peak - reference.peak));
+  if (reference.sumSquares > 0.0f)
+    diff.energy = std::max(diff.energy, (double) std::abs(stats.sumSquares - reference.sumSquares)
+                                          / (double) reference.sumSquares);
+  diff.exactMismatch = diff.exactMismatch || stats.clips != reference.clips;
+}
+
+// Renders one automation case at the kernel level, the way processBlock()
+// drives the kernels (GainSmoother segments while moving, a constant
+// after, true peak and meters on the output), through scalarKernels() and
+// each table in `simd`. Every table processes its own copy of the same
+// input with the same segments; `diffs` collects how far each one strays.
+template <typename Sample>
+void renderKernelCase(Automation automation, const juce::AudioBuffer<float>& source,
+                      const std::vector<const dsp::BasicGainKernels<Sample>*>& simd, std::vector<KernelDiff>& diffs)
+{
+  constexpr double kSampleRate = 48000.0;
+  constexpr int kBlockSize = 509; // odd, so every batch width leaves a tail
+  constexpr int kBlocks = 200;
+  constexpr int kHistory = dsp::TruePeakFilter::kTapsPerPhase - 1;
+
+  std::vector<const dsp::BasicGainKernels<Sample>*> tables { &dsp::scalarKernels<Sample>() };
+  tables.insert(tables.end(), simd.begin(), simd.end());
+
+  // Per table: kHistory samples of the previous block's output, then the block.
+  std::vector<std::vector<Sample>> buffers(tables.size(), std::vector<Sample>((size_t) (kHistory + kBlockSize)));
+  std::vector<dsp::ChannelStats> gainStats(tables.size()), measureStats(tables.size());
+  std::vector<bool> silent(tables.size());
+  std::vector<float> truePeaks(tables.size());
+
+  dsp::GainSmoother smoother;
+  smoother.reset(kSampleRate, params::kGain.spec().smoothingSeconds, params::kTrim.spec().smoothingSeconds);
+  AutomationState automationState;
+  smoother.setCurrentAndTargetValue(automationState.targets.gain, automationState.targets.trimDb);
+
+  std::vector<std::pair<int, dsp::RampSegment>> segments;
+  const auto* input = source.getReadPointer(0);
+  int sourcePos = 0;
+
+  for (int block = 0; block < kBlocks; ++block)
+  {
+    const auto& targets = updateAutomation(automation, (double) block * kBlockSize / kSampleRate, automationState);
+    smoother.setTargetValue(targets.bypass ? 1.0f : targets.gain, targets.bypass ? 0.0f : targets.trimDb);
+
+    segments.clear();
+    int done = 0;
+    while (done < kBlockSize && smoother.isSmoothing())
+    {
+      dsp::RampSegment segment;
+      const int length = smoother.nextSegment(kBlockSize - done, segment);
+      segments.emplace_back(length, segment);
+      done += length;
+    }
+    const float settledGain = smoother.getTargetGain();
+
+    for (size_t t = 0; t < tables.size(); ++t)
+    {
+      const auto& kernels = *tables[t];
+      auto& buffer = buffers[t];
+      std::copy(buffer.end() - kHistory, buffer.end(), buffer.begin());
+      Sample* data = buffer.data() + kHistory;
+
+      // Silence: all zeros, with one stray sample every other block so
+      // isSilent() also has to find it (in a batch or in the tail).
+      for (int i = 0; i < kBlockSize; ++i)
+        data[i] = automation == Automation::silence ? Sample(0)
+                                                    : (Sample) input[(sourcePos + i) % source.getNumSamples()];
+      if (automation == Automation::silence && block % 2 == 1)
+        data[(block * 37) % kBlockSize] = Sample(1.0e-3);
+
+      silent[t] = kernels.isSilent(data, kBlockSize);
+
+      gainStats[t] = {};
+      int offset = 0;
+      for (const auto& [length, segment] : segments)
+      {
+        kernels.applyRamp(data + offset, length, segment, gainStats[t]);
+        offset += length;
+      }
+      if (offset < kBlockSize)
+        kernels.applyConstant(data + offset, kBlockSize - offset, settledGain, gainStats[t]);
+
+      measureStats[t] = {};
+      kernels.measure(data, kBlockSize, measureStats[t]);
+      truePeaks[t] = kernels.truePeak(data, kBlockSize);
+    }
+    sourcePos = (sourcePos + kBlockSize) % source.getNumSamples();
+
+    for (size_t t = 1; t < tables.size(); ++t)
+    {
+      auto& diff = diffs[t - 1];
+      for (int i = kHistory; i < kHistory + kBlockSize; ++i)
+        diff.samples = std::max(diff.samples, (double) std::abs(buffers[t][(size_t) i] - buffers[0][(size_t) i]));
+      compareStats(gainStats[0], gainStats[t], diff);
+      compareStats(measureStats[0], measureStats[t], diff);
+      diff.truePeak = std::max(diff.truePeak, (double) std::abs(truePeaks[t] - truePeaks[0]));
+      diff.exactMismatch = diff.exactMismatch || silent[t] != silent[0];
+    }
+  }
+}
+
+// Every SIMD table this CPU runs against scalarKernels(), float and double,
+// over every automation case. They round differently (the SIMD ramp steps
+// its exponential gain by ratio^batchSize, sums run per lane), so each
+// value gets a tolerance: output samples 1e-5 (float) / 1e-12 (double)
+// absolute, peak and true peak 1e-5 absolute and sum of squares 1e-4
+// relative (meter statistics are float for both). isSilent() and clip
+// counts must match exactly.
+bool checkKernelsAgainstScalar()
+{
+  constexpr double kMaxSampleDiff[] = { 1.0e-5, 1.0e-12 }; // float, double
+  constexpr double kMaxPeakDiff = 1.0e-5;
+  constexpr double kMaxEnergyDiff = 1.0e-4;
+
+  const auto source = makeSource(Options {});
+  const Automation automations[] = { Automation::staticGain, Automation::ramp, Automation::jumps, Automation::lfo,
+                                     Automation::unity, Automation::silence, Automation::bypass };
+
+  bool allPassed = true;
+  auto check = [&](auto sampleTag, int precision) {
+    using Sample = decltype(sampleTag);
+    const auto simd = dsp::runnableSimdKernels<Sample>();
+    if (simd.empty())
+    {
+      std::cout << "no SIMD kernels compiled in or runnable on this CPU\n";
+      return;
+    }
+
+    for (const auto automation : automations)
+    {
+      std::vector<KernelDiff> diffs(simd.size());
+      renderKernelCase<Sample>(automation, source, simd, diffs);
+
+      for (size_t t = 0; t < simd.size(); ++t)
+      {
+        const auto& diff = diffs[t];
+        const bool passed = !diff.exactMismatch && diff.samples <= kMaxSampleDiff[precision]
+                            && diff.peak <= kMaxPeakDiff && diff.truePeak <= kMaxPeakDiff
+                            && diff.energy <= kMaxEnergyDiff;
+        allPassed = allPassed && passed;
+
+        char line[200];
+        std::snprintf(line, sizeof(line),
+                      "%-8s %-6s %-7s  samples %.1e  peak %.1e  energy %.1e  true peak %.1e  %s\n",
+                      simd[t]->name, precision == 0 ? "float" : "double", toString(automation), diff.samples,
+                      diff.peak, diff.energy, diff.truePeak,
+                      passed ? "ok" : diff.exactMismatch ? "FAIL (isSilent/clips)" : "FAIL");
+        std::cout << line;
+      }
+    }
+  };
+  check(float {}, 0);
+  check(double {}, 1);
+  return allPassed;
+}
+
+// Breaks the real-time rules on purpose and expects the RT-safety hooks to
+// count each break inside an audio-thread scope, and none outside one.
+// Needs a -DPROGAIN_RT_SAFETY=ON build.
+bool checkRealtimeSafetyHooks()
+{
+#if PROGAIN_RT_SAFETY
+  // volatile, so the compiler can't drop the allocations as unused.
+  static void* volatile sink = nullptr;
+  static std::mutex mutex;
+
+  struct Violation
+  {
+    const char* name;
+    void (*commit)();
+  };
+  const std::vector<Violation> violations {
+    { "operator new", [] { sink = new int(1); delete static_cast<int*>(sink); } },
+  #if defined(__GLIBC__)
+    { "malloc", [] { sink = std::malloc(16); std::free(sink); } },
+    { "mutex lock", [] { mutex.lock(); mutex.unlock(); } },
+  #endif
+  };
+
+  // Report, don't abort, whatever the build's default is.
+  const auto policy = rtsafety::getPolicy();
+  rtsafety::setPolicy(rtsafety::Policy::report);
+  std::cerr << "The stack traces below are expected.\n";
+
+  bool allPassed = true;
+  for (const auto& violation : violations)
+  {
+    auto before = rtsafety::getViolationCount();
+    violation.commit();
+    const bool quietOutside = rtsafety::getViolationCount() == before;
+
+    before = rtsafety::getViolationCount();
+    {
+      PROGAIN_RT_SCOPE;
+      violation.commit();
+    }
+    const bool reportedInside = rtsafety::getViolationCount() > before;
+
+    const bool passed = quietOutside && reportedInside;
+    allPassed = allPassed && passed;
+    std::cout << violation.name << ": " << (reportedInside ? "reported" : "NOT reported") << " on the audio thread, "
+              << (quietOutside ? "ignored" : "reported") << " elsewhere  " << (passed ? "ok" : "FAIL") << "\n";
+  }
+
+  rtsafety::setPolicy(policy);
+  return allPassed;
+#else
+  std::cerr << "--check-rt-safety needs a build with -DPROGAIN_RT_SAFETY=ON\n";
+  return false;
+#endif
+}
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseArgs(argc, argv, options))
+  {
+    std::cerr << "Usage: ProGainBench [--quick] [--format csv|json] [--out FILE] [--input FILE.wav]\n"
+                 "                    [--seconds N] [--kernels simd|reference|both]\n"
+                 "                    [--true-peak off|on|both] [--precision float|double|both]\n"
+                 "                    [--render FILE.wav]\n"
+                 "       ProGainBench [--check-loudness] [--check-smoother] [--check-kernels]\n"
+                 "                    [--check-rt-safety]\n";
+    return 2;
+  }
+
+  if (options.checkLoudness || options.checkSmoother || options.checkKernels || options.checkRealtimeSafety)
+  {
+    bool passed = true;
+    if (options.checkLoudness)
+      passed = checkLoudnessReferences() && passed;
+    if (options.checkSmoother)
+      passed = checkSmootherAccuracy() && passed;
+    if (options.checkKernels)
+      passed = checkKernelsAgainstScalar() && passed;
+    if (options.checkRealtimeSafety)
+      passed = checkRealtimeSafetyHooks() && passed;
+    return passed ? 0 : 1;
+  }
+
+  // APVTS needs a message manager; no window is ever created.
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  if (options.quick)
+    options.seconds = std::min(options.seconds, 2.0);
+
+  const std::vector<int> blockSizes = options.quick ? std::vector<int> { 64, 512 }
+                                                    : std::vector<int> { 32, 64, 128, 256, 512, 1024 };
+  const std::vector<int> channelCounts = options.quick ? std::vector<int> { 1, 2, 12 }
+                                                      : std::vector<int> { 1, 2, 6, 12, 16, 25 };
+  const std::vector<double> sampleRates = options.quick ? std::vector<double> { 48000.0 }
+                                                        : std::vector<double> { 44100.0, 48000.0, 96000.0 };
+  const std::vector<Automation> automations { Automation::staticGain, Automation::ramp, Automation::jumps,
+                                              Automation::lfo, Automation::unity, Automation::silence,
+                                              Automation::bypass };
+
+  std::vector<bool> kernelModes;
+  if (options.kernels != "reference")
+    kernelModes.push_back(false);
+  if (options.kernels != "simd")
+    kernelModes.push_back(true);
+
+  std::vector<bool> truePeakModes;
+  if (options.truePeak != "on")
+    truePeakModes.push_back(false);
+  if (options.truePeak != "off")
+    truePeakModes.push_back(true);
+
+  std::vector<bool> precisionModes;
+  if (options.precision != "double")
+    precisionModes.push_back(false);
+  if (options.precision != "float")
+    precisionModes.push_back(true);
+
+  const auto source = makeSource(options);
+
+  juce::String kernelInfo;
+  {
+    ProGainAudioProcessor probe;
+    probe.prepareToPlay(48000.0, 512);
+    kernelInfo = probe.getKernelDiagnostics();
+  }
+  std::cerr << kernelInfo << "\n";
+
+  std::vector<Result> results;
+  bool rendered = options.renderPath.empty();
+
+  for (bool reference : kernelModes)
+    for (bool truePeak : truePeakModes)
+      for (bool doublePrecision : precisionModes)
+        for (double sampleRate : sampleRates)
+          for (int channels : channelCounts)
+            for (int blockSize : blockSizes)
+              for (Automation automation : automations)
+              {
+                const Config config { reference, truePeak, doublePrecision, sampleRate, channels, blockSize,
+                                      automation };
+                juce::AudioBuffer<float> renderBuffer;
+                results.push_back(runConfig(config, options, source, rendered ? nullptr : &renderBuffer));
+
+                if (!rendered)
+                {
+                  rendered = true;
+                  if (!writeWav(options.renderPath, renderBuffer, sampleRate))
+                    std::cerr << "Could not write " << options.renderPath << "\n";
+                }
+              }
+
+  const std::string report = options.format == "json" ? formatJson(results, kernelInfo) : formatCsv(results);
+
+  if (options.outPath.empty())
+    std::cout << report;
+  else if (!juce::File::getCurrentWorkingDirectory().getChildFile(options.outPath).replaceWithText(report))
+  {
+    std::cerr << "Could not write " << options.outPath << "\n";
+    return 1;
+  }
+
+#if PROGAIN_RT_SAFETY
+  // In RT-safety builds the benchmark doubles as a check: fail on any
+  // allocation or lock seen inside processBlock().
+  const auto violations = rtsafety::getViolationCount();
+  if (violations > 0)
+  {
+    std::cerr << violations << " real-time violation(s) in processBlock()\n";
+    return 1;
+  }
+#endif
+
+  return 0;
+}
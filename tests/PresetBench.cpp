@@ -0,0 +1,365 @@
+/**
+  PresetBench.cpp
+  ---------------
+  Headless benchmark for the preset/state path of ProGainAudioProcessor.
+
+  Compares the binary state format (infra/state/StateCodec) against the
+  legacy ValueTree -> XML -> copyXmlToBinary round-trip it replaced:
+  - encode: getStateInformation() vs copyState() + createXml() + copyXmlToBinary()
+  - decode: setStateInformation() with binary data vs with legacy XML data
+    (the legacy path is still what loads old sessions and presets)
+  - decode_factory: name lookup + load of a built-in factory preset
+    (infra/state/FactoryBank), which skips decoding altogether
+
+  Then fills a fresh PresetStore with --presets rows (default 100k, 0 skips
+  this part) and times the library queries at that size:
+  - store_save: one savePreset() while filling (64 distinct states)
+  - store_blobs: distinct state blobs stored (rows) and their bytes
+  - store_list_all: listPresets() (every name, the pre-paging API)
+  - store_first_page / store_page_walk: findPresets() newest-first, the
+    second one averaged over paging through the whole library
+  - store_search_*: full-text search, broad ("warm", 1/8 of all rows),
+    narrow (three words) and rare (one match); store_search_walk pages
+    through every result of the broad one, averaged per page
+  - store_bank_export / store_bank_import: the whole library to a bank
+    file and into an empty database; per preset, so ops_per_sec is
+    presets/sec
+  For the store rows, `rows` is how many presets the call returned.
+
+  Usage:
+    ProGainPresetBench [--iterations 20000] [--presets 100000] [--db FILE]
+                       [--format csv|json] [--out FILE]
+*/
+#include <JuceHeader.h>
+
+#include "PluginProcessor.h"
+#include "infra/state/FactoryBank.h"
+#include "infra/state/PresetStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Options
+{
+  int iterations { 20000 };
+  int presets { 100000 };
+  std::string dbPath; // default: a temporary file, deleted afterwards
+  std::string format { "csv" };
+  std::string outPath;
+};
+
+struct Result
+{
+  std::string name;
+  size_t bytes { 0 };
+  double nsPerOp { 0.0 };
+  size_t rows { 0 };
+};
+
+constexpr int kPageSize = 100;
+
+bool parseArgs(int argc, char* argv[], Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--iterations" && i + 1 < argc)
+      options.iterations = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--presets" && i + 1 < argc)
+      options.presets = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--db" && i + 1 < argc)
+      options.dbPath = argv[++i];
+    else if (arg == "--format" && i + 1 < argc)
+      options.format = argv[++i];
+    else if (arg == "--out" && i + 1 < argc)
+      options.outPath = argv[++i];
+    else
+    {
+      std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+      return false;
+    }
+  }
+  return options.format == "csv" || options.format == "json";
+}
+
+template <typename Fn>
+double timeNsPerOp(int iterations, Fn&& fn)
+{
+  // One untimed pass to warm caches and allocators.
+  fn();
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    fn();
+  const auto end = std::chrono::steady_clock::now();
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / iterations;
+}
+
+juce::MemoryBlock legacyState(ProGainAudioProcessor& processor)
+{
+  juce::MemoryBlock block;
+  auto state = processor.getAPVTS().copyState();
+  std::unique_ptr<juce::XmlElement> xml(state.createXml());
+  juce::AudioProcessor::copyXmlToBinary(*xml, block);
+  return block;
+}
+
+// Names + tags drawn from small word lists, so searches hit a known share
+// of the library: "Warm Bass 00042" tagged "bass analog".
+void fillStore(PresetStore& store, int count, const std::vector<std::string>& states, std::vector<Result>& results)
+{
+  static const char* const adjectives[] = { "Warm", "Bright", "Dark", "Fat", "Thin", "Wide", "Soft", "Hard" };
+  static const char* const nouns[] = { "Bass", "Lead", "Pad", "Vocal", "Drum", "Keys", "Bus", "Master" };
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i)
+  {
+    const std::string noun = nouns[(i / 8) % 8];
+    char number[16];
+    std::snprintf(number, sizeof(number), "%05d", i);
+    const std::string name = std::string(adjectives[i % 8]) + ' ' + noun + ' ' + number;
+    const std::string tags = juce::String(noun).toLowerCase().toStdString() + (i % 3 ? " analog" : " digital");
+    if (!store.savePreset(name, states[(size_t) i % states.size()], tags))
+    {
+      std::cerr << "savePreset failed: " << store.lastError() << "\n";
+      break;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  results.push_back({ "store_save", states.front().size(),
+                      (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                        / std::max(1, count),
+                      1 });
+}
+
+double nsSince(std::chrono::steady_clock::time_point start)
+{
+  return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+void deleteDatabase(const juce::File& dbFile)
+{
+  dbFile.deleteFile();
+  dbFile.withFileExtension(".db-wal").deleteFile();
+  dbFile.withFileExtension(".db-shm").deleteFile();
+}
+
+// Whole library -> bank file -> empty database, like moving to a new
+// machine. ns_per_op is per preset; ops_per_sec is presets/sec.
+void benchBank(PresetStore& source, std::vector<Result>& results)
+{
+  const auto bankFile = juce::File::createTempFile(".pgbank");
+  const auto targetFile = juce::File::createTempFile(".db");
+
+  size_t exported = 0;
+  auto start = std::chrono::steady_clock::now();
+  if (!source.exportBank(bankFile.getFullPathName().toStdString(), exported) || exported == 0)
+  {
+    std::cerr << "exportBank failed\n";
+    return;
+  }
+  results.push_back({ "store_bank_export", (size_t) bankFile.getSize(), nsSince(start) / (double) exported, exported });
+
+  {
+    PresetStore target;
+    target.open(targetFile.getFullPathName().toStdString());
+
+    size_t imported = 0;
+    start = std::chrono::steady_clock::now();
+    const juce::MemoryMappedFile mapped(bankFile, juce::MemoryMappedFile::readOnly);
+    if (mapped.getData() == nullptr || !target.importBank(mapped.getData(), mapped.getSize(), imported))
+      std::cerr << "importBank failed: " << target.lastError() << "\n";
+    else
+      results.push_back({ "store_bank_import", (size_t) bankFile.getSize(), nsSince(start) / (double) imported, imported });
+  }
+
+  bankFile.deleteFile();
+  deleteDatabase(targetFile);
+}
+
+void benchStore(const Options& options, const std::vector<std::string>& states, std::vector<Result>& results)
+{
+  const auto dbFile = options.dbPath.empty()
+                        ? juce::File::createTempFile(".db")
+                        : juce::File::getCurrentWorkingDirectory().getChildFile(options.dbPath);
+  dbFile.deleteFile();
+
+  {
+    PresetStore store;
+    if (!store.open(dbFile.getFullPathName().toStdString()))
+    {
+      std::cerr << "Could not open " << dbFile.getFullPathName() << ": " << store.lastError() << "\n";
+      return;
+    }
+    if (!store.hasFullTextSearch())
+      std::cerr << "SQLite has no FTS5; store_search_* measure the LIKE fallback\n";
+
+    fillStore(store, options.presets, states, results);
+
+    // Distinct states actually stored, and their bytes on disk.
+    const auto storage = store.storageStats();
+    results.push_back({ "store_blobs", (size_t) storage.storedBytes, 0.0, storage.blobs });
+
+    // Queries are far slower than the codec, so fewer iterations.
+    const int iterations = std::max(1, options.iterations / 100);
+    size_t rows = 0;
+
+    results.push_back({ "store_list_all", 0, timeNsPerOp(std::max(1, iterations / 20), [&] {
+      rows = store.listPresets().size();
+    }), 0 });
+    results.back().rows = rows;
+
+    auto timeQuery = [&](const char* name, const std::string& text) {
+      PresetStore::Query query;
+      query.text = text;
+      query.limit = kPageSize;
+      results.push_back({ name, 0, timeNsPerOp(iterations, [&] {
+        rows = store.findPresets(query).items.size();
+      }), 0 });
+      results.back().rows = rows;
+    };
+
+    timeQuery("store_first_page", {});
+
+    // Every page of the results, averaged per page.
+    auto walkPages = [&](const char* name, const std::string& text) {
+      PresetStore::Query query;
+      query.text = text;
+      query.limit = kPageSize;
+      size_t pages = 0;
+      rows = 0;
+      const auto start = std::chrono::steady_clock::now();
+      for (;;)
+      {
+        auto page = store.findPresets(query);
+        rows += page.items.size();
+        ++pages;
+        if (!page.hasMore)
+          break;
+        query.after = page.next;
+      }
+      results.push_back({ name, 0, nsSince(start) / (double) pages, rows / pages });
+    };
+
+    walkPages("store_page_walk", {});
+
+    timeQuery("store_search_broad", "warm");
+    walkPages("store_search_walk", "warm");
+    timeQuery("store_search_narrow", "fat pad 0");
+    timeQuery("store_search_rare", "99999");
+
+    benchBank(store, results);
+  }
+
+  if (options.dbPath.empty())
+    deleteDatabase(dbFile);
+}
+
+double opsPerSec(const Result& result)
+{
+  return result.nsPerOp > 0.0 ? 1.0e9 / result.nsPerOp : 0.0;
+}
+
+std::string format(const std::vector<Result>& results, const std::string& formatName)
+{
+  std::ostringstream out;
+  if (formatName == "json")
+  {
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+      out << "    {\"name\": \"" << results[i].name << "\", \"bytes\": " << results[i].bytes
+          << ", \"nsPerOp\": " << results[i].nsPerOp << ", \"opsPerSec\": " << opsPerSec(results[i])
+          << ", \"rows\": " << results[i].rows << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    out << "  ]\n}\n";
+    return out.str();
+  }
+
+  out << "name,bytes,ns_per_op,ops_per_sec,rows\n";
+  for (const auto& r : results)
+    out << r.name << ',' << r.bytes << ',' << r.nsPerOp << ',' << opsPerSec(r) << ',' << r.rows << '\n';
+  return out.str();
+}
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseArgs(argc, argv, options))
+  {
+    std::cerr << "Usage: ProGainPresetBench [--iterations N] [--presets N] [--db FILE]"
+                 " [--format csv|json] [--out FILE]\n";
+    return 2;
+  }
+
+  // APVTS needs a message manager; no window is ever created.
+  juce::ScopedJuceInitialiser_GUI juceInit;
+
+  ProGainAudioProcessor processor;
+  if (auto* gain = processor.getAPVTS().getParameter("gain"))
+    gain->setValueNotifyingHost(gain->convertTo0to1(0.8f));
+
+  juce::MemoryBlock binary;
+  processor.getStateInformation(binary);
+  const auto legacy = legacyState(processor);
+
+  std::vector<Result> results;
+
+  results.push_back({ "encode_binary", binary.getSize(), timeNsPerOp(options.iterations, [&] {
+    juce::MemoryBlock block;
+    processor.getStateInformation(block);
+  }) });
+
+  results.push_back({ "encode_legacy_xml", legacy.getSize(), timeNsPerOp(options.iterations, [&] {
+    legacyState(processor);
+  }) });
+
+  results.push_back({ "decode_binary", binary.getSize(), timeNsPerOp(options.iterations, [&] {
+    processor.setStateInformation(binary.getData(), (int) binary.getSize());
+  }) });
+
+  results.push_back({ "decode_legacy_xml", legacy.getSize(), timeNsPerOp(options.iterations, [&] {
+    processor.setStateInformation(legacy.getData(), (int) legacy.getSize());
+  }) });
+
+  const auto& factory = state::getFactoryPreset(0);
+  results.push_back({ "decode_factory", sizeof(factory.values), timeNsPerOp(options.iterations, [&] {
+    if (const auto* preset = state::findFactoryPreset(factory.name))
+      processor.loadFactoryPreset(*preset);
+  }) });
+
+  if (options.presets > 0)
+  {
+    // A realistic library reuses a limited set of states: 64 gain settings
+    // spread over all presets, so most saves are duplicates.
+    std::vector<std::string> states;
+    for (int i = 0; i < 64; ++i)
+    {
+      if (auto* gain = processor.getAPVTS().getParameter("gain"))
+        gain->setValueNotifyingHost(gain->convertTo0to1(-24.0f + 0.5f * (float) i));
+      juce::MemoryBlock state;
+      processor.getStateInformation(state);
+      states.emplace_back(static_cast<const char*>(state.getData()), state.getSize());
+    }
+    benchStore(options, states, results);
+  }
+
+  const auto report = format(results, options.format);
+  if (options.outPath.empty())
+    std::cout << report;
+  else if (!juce::File::getCurrentWorkingDirectory().getChildFile(options.outPath).replaceWithText(report))
+  {
+    std::cerr << "Could not write " << options.outPath << "\n";
+    return 1;
+  }
+  return 0;
+}